@@ -0,0 +1,211 @@
+#include "BlockFrequency.h"
+#include "../DominatorTreePass/DominatorTree.h"
+#include "../DominatorTreePass/LoopNestingForest.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Metadata.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+static const double BackEdgeWeight = 31;
+// Najveci broj izvrsavanja zaglavlja po ulasku u petlju, za petlje iz kojih se (skoro) ne izlazi
+static const double MaxLoopScale = 4096;
+
+// Tezine successora iz branch_weights: !{!"branch_weights", i32 w1, i32 w2, ...}, po jedna za svaku
+// granu, redom kao successori skoka (isto kao u DenseCFG-u).
+static bool GetBranchWeights(Instruction *Terminator, unsigned NumOfSuccessors, std::vector<double> &Weights)
+{
+    MDNode* Profile = Terminator->getMetadata(LLVMContext::MD_prof);
+    if (Profile == nullptr || Profile->getNumOperands() != NumOfSuccessors + 1)
+        return false;
+
+    MDString* Kind = dyn_cast<MDString>(Profile->getOperand(0));
+    if (Kind == nullptr || Kind->getString() != "branch_weights")
+        return false;
+
+    Weights.clear();
+    for (unsigned Operand = 1; Operand <= NumOfSuccessors; ++Operand) {
+        ConstantInt* Weight = mdconst::dyn_extract<ConstantInt>(Profile->getOperand(Operand));
+        if (Weight == nullptr)
+            return false;
+        Weights.push_back(Weight->getZExtValue());
+    }
+    return true;
+}
+
+// Povratne grane su grane ka pretku u DFS stablu, kao u DeadCodeElimination/CFG.cpp, ukljucujuci
+// petlju B -> B.
+void BlockFrequency::ComputeProbabilities(bool UseBranchWeights)
+{
+    unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+    DFSOrder<unsigned> Order(NumOfBlocks);
+    Order.Run(0u, [this](unsigned Node) { return Graph->GetSuccessors(Node); });
+
+    Probabilities.assign(NumOfBlocks, {});
+    std::vector<double> Weights;
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block) {
+        ArrayRef<unsigned> Successors = Graph->GetSuccessors(Block);
+        if (Successors.empty())
+            continue;
+
+        if (UseBranchWeights && GetBranchWeights(Graph->GetBlock(Block)->getTerminator(), Successors.size(), Weights)) {
+            NumOfProfiled++;
+        } else {
+            Weights.clear();
+            for (unsigned Successor : Successors) {
+                if (isa<UnreachableInst>(Graph->GetBlock(Successor)->getTerminator()))
+                    Weights.push_back(0);
+                else
+                    Weights.push_back(Order.IsBackEdge(Block, Successor) ? BackEdgeWeight : 1);
+            }
+        }
+
+        double Sum = std::accumulate(Weights.begin(), Weights.end(), 0.0);
+        if (Sum == 0) {
+            std::fill(Weights.begin(), Weights.end(), 1.0);
+            Sum = Weights.size();
+        }
+
+        // Vise grana ka istom bloku (npr. case-ovi switch-a) je jedna grana sa zbirom verovatnoca
+        auto &Edges = Probabilities[Block];
+        for (unsigned Index = 0; Index < Successors.size(); ++Index) {
+            auto Edge = std::find_if(Edges.begin(), Edges.end(),
+                                     [&](const std::pair<unsigned, double> &E) { return E.first == Successors[Index]; });
+            if (Edge == Edges.end())
+                Edges.push_back({Successors[Index], Weights[Index] / Sum});
+            else
+                Edge->second += Weights[Index] / Sum;
+        }
+    }
+}
+
+// Ucestanosti se racunaju bez ponavljanja prolaza, kao BlockFrequencyInfo u LLVM-u. Petlje iz sume
+// petlji se obradjuju od unutrasnjih ka spoljasnjim: jednim prolazom kroz telo petlje u RPO-u, sa
+// masom 1 u zaglavlju, dobija se masa koja se vraca u zaglavlje (ciklicna verovatnoca p) i masa koja
+// izlazi svakom izlaznom granom. Zaglavlje se po ulasku u petlju izvrsava 1 / (1 - p) puta (najvise
+// MaxLoopScale). Vec obradjena unutrasnja petlja je u telu spoljasnje jedan cvor, njeno zaglavlje,
+// koji masu prosledjuje svojim izlazima. Na kraju se isto radi za celu funkciju, a ucestanost bloka
+// je njegova masa u najdubljoj petlji puta broj izvrsavanja zaglavlja te petlje. Kod nesvodljive
+// petlje se masa koja udje mimo zaglavlja racuna kao da je usla u zaglavlje. Nedostizni blokovi
+// imaju ucestanost 0.
+void BlockFrequency::ComputeFrequencies()
+{
+    unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+    Frequencies.assign(NumOfBlocks, 0);
+    if (NumOfBlocks == 0)
+        return;
+
+    // U RPO-u unazad vode samo grane ka pretku u DFS stablu, a blok sa vecim postorder brojem je raniji
+    DFSOrder<unsigned> Order(NumOfBlocks);
+    Order.Run(0u, [this](unsigned Node) { return Graph->GetSuccessors(Node); });
+    auto ComesBefore = [&Order](unsigned A, unsigned B) {
+        return Order.PostorderNumber[A] > Order.PostorderNumber[B];
+    };
+
+    Function &F = *Graph->GetBlock(0)->getParent();
+    DominatorTree DomTree(F);
+    DomTree.FindImmediateDominators();
+    LoopNestingForest Forest(F, DomTree);
+
+    // Petlje su numerisane od unutrasnjih ka spoljasnjim, a cela funkcija je petlja NumOfLoops sa
+    // zaglavljem 0. Telo petlje (Items) su blokovi kojima je ona najdublja petlja i zaglavlja
+    // njenih neposrednih podpetlji, u RPO-u.
+    std::vector<OurLoop*> Loops = Forest.GetLoopsInnermostFirst();
+    unsigned NumOfLoops = Loops.size();
+    std::unordered_map<OurLoop*, unsigned> LoopIndex;
+    for (unsigned Loop = 0; Loop < NumOfLoops; ++Loop)
+        LoopIndex[Loops[Loop]] = Loop;
+
+    std::vector<unsigned> ParentLoop(NumOfLoops + 1, NumOfLoops);
+    std::vector<unsigned> HeaderOf(NumOfLoops + 1, 0);
+    for (unsigned Loop = 0; Loop < NumOfLoops; ++Loop) {
+        if (Loops[Loop]->GetParentLoop())
+            ParentLoop[Loop] = LoopIndex[Loops[Loop]->GetParentLoop()];
+        HeaderOf[Loop] = Graph->GetIndex(Loops[Loop]->GetHeader());
+    }
+
+    std::vector<unsigned> InnermostLoop(NumOfBlocks, NumOfLoops);
+    std::vector<std::vector<unsigned>> Items(NumOfLoops + 1);
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block) {
+        if (!Order.IsVisited(Block))
+            continue;
+        if (OurLoop* L = Forest.GetLoopFor(Graph->GetBlock(Block)))
+            InnermostLoop[Block] = LoopIndex[L];
+        Items[InnermostLoop[Block]].push_back(Block);
+    }
+    for (unsigned Loop = 0; Loop < NumOfLoops; ++Loop)
+        Items[ParentLoop[Loop]].push_back(HeaderOf[Loop]);
+    for (std::vector<unsigned> &Body : Items)
+        std::sort(Body.begin(), Body.end(), ComesBefore);
+
+    // Blok koji u telu petlje Loop predstavlja Block: sam blok, zaglavlje podpetlje u kojoj je, ili
+    // -1 ako Block nije u petlji
+    auto Representative = [&](unsigned Block, unsigned Loop) {
+        unsigned Inner = InnermostLoop[Block];
+        while (Inner != Loop && Inner != NumOfLoops && ParentLoop[Inner] != Loop)
+            Inner = ParentLoop[Inner];
+        if (Inner == Loop)
+            return static_cast<int>(Block);
+        return Inner == NumOfLoops ? -1 : static_cast<int>(HeaderOf[Inner]);
+    };
+
+    std::vector<double> Mass(NumOfBlocks, 0);
+    std::vector<double> LocalMass(NumOfBlocks, 0);
+    std::vector<double> EntryMass(NumOfLoops + 1, 1);
+    std::vector<double> LoopScale(NumOfLoops + 1, 1);
+    // (blok van petlje, masa koja u njega izlazi po ulasku u petlju)
+    std::vector<std::vector<std::pair<unsigned, double>>> ExitMass(NumOfLoops + 1);
+
+    for (unsigned Loop = 0; Loop <= NumOfLoops; ++Loop) {
+        double BackMass = 0;
+        auto Distribute = [&](unsigned From, unsigned To, double Amount) {
+            int Target = Representative(To, Loop);
+            if (Target == -1)
+                ExitMass[Loop].push_back({To, Amount});
+            else if (!ComesBefore(From, Target))
+                BackMass += Amount;
+            else
+                Mass[Target] += Amount;
+        };
+
+        Mass[HeaderOf[Loop]] = 1;
+        for (unsigned Item : Items[Loop]) {
+            double ItemMass = Mass[Item];
+            Mass[Item] = 0;
+
+            unsigned SubLoop = InnermostLoop[Item];
+            if (SubLoop == Loop) {
+                LocalMass[Item] = ItemMass;
+                for (const auto &Edge : Probabilities[Item])
+                    Distribute(Item, Edge.first, ItemMass * Edge.second);
+            } else {
+                EntryMass[SubLoop] = ItemMass;
+                for (const auto &Exit : ExitMass[SubLoop])
+                    Distribute(Item, Exit.first, ItemMass * Exit.second);
+            }
+        }
+
+        BackMass = std::min(BackMass, 1 - 1 / MaxLoopScale);
+        LoopScale[Loop] = 1 / (1 - BackMass);
+        for (auto &Exit : ExitMass[Loop])
+            Exit.second *= LoopScale[Loop];
+    }
+
+    // Broj izvrsavanja zaglavlja po izvrsavanju funkcije; spoljasnja petlja ima veci broj
+    std::vector<double> HeaderFrequency(NumOfLoops + 1, 1);
+    for (unsigned Loop = NumOfLoops; Loop-- > 0;)
+        HeaderFrequency[Loop] = HeaderFrequency[ParentLoop[Loop]] * EntryMass[Loop] * LoopScale[Loop];
+
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block)
+        Frequencies[Block] = HeaderFrequency[InnermostLoop[Block]] * LocalMass[Block];
+}
+
+void BlockFrequency::Compute(std::shared_ptr<const DenseCFG> NewGraph, bool UseBranchWeights)
+{
+    Graph = std::move(NewGraph);
+    NumOfProfiled = 0;
+    ComputeProbabilities(UseBranchWeights);
+    ComputeFrequencies();
+}
@@ -0,0 +1,40 @@
+#ifndef BLOCKFREQUENCY_H
+#define BLOCKFREQUENCY_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "../Graph/DenseCFG.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+// Verovatnoce grana i ucestanosti blokova nad DenseCFG-om:
+//  - verovatnoce grana su iz branch_weights metapodataka (npr. iz profila), a bez njih (ili kada se
+//    ne koriste) su grane jednake, osim sto je povratna grana (u DFS-u) 31 puta verovatnija od
+//    ostalih, a grana ka bloku koji se zavrsava sa unreachable nikad nije izvrsena
+//  - ucestanost bloka je zbir ucestanosti prethodnika puta verovatnoca grane, a ulazni blok ima 1;
+//    racuna se tacno, jednim prolazom po petlji iz sume petlji (nase stablo dominatora), od
+//    unutrasnjih ka spoljasnjim, bez iteriranja do ustaljenja
+// Procena bez metapodataka zavisi samo od oblika CFG-a.
+class BlockFrequency {
+private:
+    std::shared_ptr<const DenseCFG> Graph;
+    // Za svaki blok: (successor, verovatnoca), grane ka istom bloku sabrane
+    std::vector<std::vector<std::pair<unsigned, double>>> Probabilities;
+    std::vector<double> Frequencies;
+    unsigned NumOfProfiled;
+
+    void ComputeProbabilities(bool);
+    void ComputeFrequencies();
+public:
+    void Compute(std::shared_ptr<const DenseCFG>, bool UseBranchWeights = true);
+
+    const std::vector<std::pair<unsigned, double>>& GetProbabilities(unsigned Block) const { return Probabilities[Block]; }
+    double GetFrequency(unsigned Block) const { return Frequencies[Block]; }
+    unsigned GetNumOfProfiled() const { return NumOfProfiled; }
+};
+
+#endif // BLOCKFREQUENCY_H
@@ -0,0 +1,168 @@
+#include "BlockPlacement.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <tuple>
+
+void BlockPlacement::SetColdRatio(double NewColdRatio)
+{
+    ColdRatio = NewColdRatio;
+}
+
+// Pettis-Hansen: lanci su liste blokova (Next), a skup blokova jednog lanca se vodi kroz union-find
+// sa vodjom lanca. Posle spajanja se lanci postavljaju pohlepno: prvi je lanac ulaznog bloka, a
+// zatim uvek onaj sa najvecom ukupnom tezinom grana ka i od vec postavljenih lanaca. Lanac koji
+// nije povezan sa postavljenima dolazi redom iz funkcije, a hladni lanci idu poslednji.
+void BlockPlacement::BuildOrder()
+{
+    unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+    Cold.assign(NumOfBlocks, false);
+    for (unsigned Block = 1; Block < NumOfBlocks; ++Block) {
+        Cold[Block] = Frequency.GetFrequency(Block) < ColdRatio * Frequency.GetFrequency(0);
+        NumOfCold += Cold[Block];
+    }
+
+    std::vector<std::tuple<double, unsigned, unsigned>> Edges;
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block)
+        for (const auto &Edge : Frequency.GetProbabilities(Block))
+            if (Edge.first != Block && Edge.first != 0 && Cold[Block] == Cold[Edge.first])
+                Edges.emplace_back(Frequency.GetFrequency(Block) * Edge.second, Block, Edge.first);
+    std::stable_sort(Edges.begin(), Edges.end(),
+                     [](const auto &A, const auto &B) { return std::get<0>(A) > std::get<0>(B); });
+
+    std::vector<unsigned> Leader(NumOfBlocks);
+    std::vector<unsigned> Tail(NumOfBlocks);
+    std::vector<int> Next(NumOfBlocks, -1);
+    std::vector<bool> IsHead(NumOfBlocks, true);
+    std::iota(Leader.begin(), Leader.end(), 0);
+    std::iota(Tail.begin(), Tail.end(), 0);
+
+    auto Find = [&Leader](unsigned Block) {
+        while (Leader[Block] != Block)
+            Block = Leader[Block] = Leader[Leader[Block]];
+        return Block;
+    };
+
+    for (const auto &Edge : Edges) {
+        unsigned From = std::get<1>(Edge);
+        unsigned To = std::get<2>(Edge);
+        unsigned FromChain = Find(From);
+        unsigned ToChain = Find(To);
+
+        if (FromChain == ToChain || Tail[FromChain] != From || !IsHead[To])
+            continue;
+
+        Next[From] = To;
+        IsHead[To] = false;
+        Leader[ToChain] = FromChain;
+        Tail[FromChain] = Tail[ToChain];
+    }
+
+    // Vodja u union-find-u ne mora biti pocetak lanca, pa se za svakog vodju pamti pocetak
+    std::vector<unsigned> HeadOf(NumOfBlocks);
+    std::vector<unsigned> Heads;
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block) {
+        if (!IsHead[Block])
+            continue;
+        HeadOf[Find(Block)] = Block;
+        Heads.push_back(Block);
+    }
+    NumOfChains = Heads.size();
+
+    std::vector<bool> Placed(NumOfBlocks, false);
+    std::vector<double> Connection(NumOfBlocks, 0);
+    // (tezina veze, -pocetak lanca), da bi kod jednakih tezina prednost imao raniji lanac
+    std::priority_queue<std::pair<double, long>> Candidates;
+
+    auto Place = [&](unsigned Head) {
+        for (int Block = Head; Block != -1; Block = Next[Block]) {
+            Placed[Block] = true;
+            Order.push_back(Block);
+        }
+
+        for (int Block = Head; Block != -1; Block = Next[Block]) {
+            auto Connect = [&](unsigned Other, double Weight) {
+                unsigned OtherHead = HeadOf[Find(Other)];
+                if (Placed[OtherHead] || Cold[OtherHead] || Weight == 0)
+                    return;
+                Connection[OtherHead] += Weight;
+                Candidates.push({Connection[OtherHead], -static_cast<long>(OtherHead)});
+            };
+
+            for (const auto &Edge : Frequency.GetProbabilities(Block))
+                Connect(Edge.first, Frequency.GetFrequency(Block) * Edge.second);
+            // Prethodnici su poredjani po indeksu, pa su ponovljeni jedan do drugog
+            ArrayRef<unsigned> Predecessors = Graph->GetPredecessors(Block);
+            for (unsigned Index = 0; Index < Predecessors.size(); ++Index) {
+                unsigned Predecessor = Predecessors[Index];
+                if (Index > 0 && Predecessors[Index - 1] == Predecessor)
+                    continue;
+                for (const auto &Edge : Frequency.GetProbabilities(Predecessor))
+                    if (Edge.first == static_cast<unsigned>(Block))
+                        Connect(Predecessor, Frequency.GetFrequency(Predecessor) * Edge.second);
+            }
+        }
+    };
+
+    Place(0);
+    auto NextHead = Heads.begin();
+    while (true) {
+        int Head = -1;
+        while (!Candidates.empty()) {
+            auto Candidate = Candidates.top();
+            Candidates.pop();
+            unsigned CandidateHead = -Candidate.second;
+            if (!Placed[CandidateHead] && Candidate.first == Connection[CandidateHead]) {
+                Head = CandidateHead;
+                break;
+            }
+        }
+
+        for (; Head == -1 && NextHead != Heads.end(); ++NextHead)
+            if (!Placed[*NextHead] && !Cold[*NextHead])
+                Head = *NextHead;
+
+        if (Head == -1)
+            break;
+        Place(Head);
+    }
+
+    for (unsigned Head : Heads)
+        if (!Placed[Head])
+            Place(Head);
+}
+
+bool BlockPlacement::Run(Function &F)
+{
+    NumOfChains = NumOfCold = 0;
+    Order.clear();
+    if (F.isDeclaration())
+        return false;
+
+    Graph = DenseCFG::Get(F);
+    Frequency.Compute(Graph);
+    BuildOrder();
+
+    bool Changed = false;
+    for (unsigned Position = 0; Position < Order.size(); ++Position)
+        Changed |= Order[Position] != Position;
+    if (!Changed)
+        return false;
+
+    BasicBlock* Previous = Graph->GetBlock(Order[0]);
+    for (unsigned Position = 1; Position < Order.size(); ++Position) {
+        BasicBlock* BB = Graph->GetBlock(Order[Position]);
+        BB->moveAfter(Previous);
+        Previous = BB;
+    }
+    return true;
+}
+
+void BlockPlacement::PrintStatistics(raw_ostream &Out, Function &F) const
+{
+    Out << "--- Block placement of '" << F.getName() << "': " << Order.size() << " blocks in " << NumOfChains
+        << " chains, " << NumOfCold << " cold blocks at the end, " << Frequency.GetNumOfProfiled()
+        << " branches with profile weights ---\n";
+}
@@ -0,0 +1,41 @@
+#ifndef BLOCKPLACEMENT_H
+#define BLOCKPLACEMENT_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "../Graph/DenseCFG.h"
+#include "BlockFrequency.h"
+
+#include <memory>
+#include <vector>
+
+using namespace llvm;
+
+// Raspored BasicBlock-ova po Pettis-Hansen-u, nad tezinskim CFG-om:
+//  - verovatnoce grana i ucestanosti blokova su iz BlockFrequency (profil ili procena)
+//  - tezina grane je ucestanost izvora puta verovatnoca; grane se obradjuju od najteze, a grana
+//    spaja dva lanca ako je izvor kraj jednog, a odrediste pocetak drugog
+//  - lanac ulaznog bloka ide prvi, zatim uvek lanac najjace povezan sa vec postavljenim, a hladni
+//    blokovi (ucestanost ispod ColdRatio, ukljucujuci nedostizne) se ne spajaju sa toplim i idu na
+//    kraj funkcije
+// IR nema propadanje kroz blokove, pa se skokovi ne menjaju; redosled koristi generator koda, koji
+// za susedni successor ne pravi skok.
+class BlockPlacement {
+private:
+    std::shared_ptr<const DenseCFG> Graph;
+    double ColdRatio = 0.001;
+    BlockFrequency Frequency;
+
+    std::vector<bool> Cold;
+    std::vector<unsigned> Order;
+    unsigned NumOfChains;
+    unsigned NumOfCold;
+
+    void BuildOrder();
+public:
+    void SetColdRatio(double);
+    bool Run(Function&);
+    void PrintStatistics(raw_ostream&, Function&) const;
+};
+
+#endif // BLOCKPLACEMENT_H
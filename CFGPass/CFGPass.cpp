@@ -1,12 +1,32 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "OurCFG.h"
+#include "CFGSimplification.h"
+#include "BlockPlacement.h"
+#include "EdgeProfile.h"
 
 using namespace llvm;
 
+static cl::opt<GraphFormat> Format("cfg-format", cl::init(GraphFormat::Dot),
+                                    cl::desc("Format of the CFG files"),
+                                    cl::values(clEnumValN(GraphFormat::Dot, "dot", "Graphviz .dot"),
+                                               clEnumValN(GraphFormat::Json, "json", "JSON with nodes and edges"),
+                                               clEnumValN(GraphFormat::EdgeList, "edges",
+                                                          "Edge list, readable by the Dominators tool")));
+static cl::opt<bool> NoBodies("cfg-no-bodies", cl::init(false),
+                              cl::desc("Write only block names and edges, without instructions"));
+static cl::opt<unsigned> NumOfThreads("cfg-threads", cl::init(0),
+                                      cl::desc("Worker threads for the module-wide CFG pass (0 means one per core)"));
+static cl::opt<double> ColdRatio("block-placement-cold-ratio", cl::init(0.001),
+                                 cl::desc("Blocks executed less often than this fraction of the entry block "
+                                          "are cold and placed at the end of the function"));
+static cl::opt<std::string> ProfileFile("edge-profile-file", cl::init("edge_profile.bin"),
+                                        cl::desc("Edge profile written by a program instrumented with -our-edge-profile"));
+
 namespace {
 
 struct OurCFGPass : public FunctionPass {
@@ -17,13 +37,143 @@ struct OurCFGPass : public FunctionPass {
         OurCFG *CFG = new OurCFG();
 
         CFG->CreateCFG(F);
+        CFG->SetExportOptions({Format, !NoBodies});
         CFG->DumpToFile();
 
         delete CFG;
         return false;       // vracamo false zato sto je Analysis pass, ne menja se IR
     }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
+};
+
+// CFG-ovi svih funkcija modula odjednom, svaka funkcija na svojoj niti
+struct OurModuleCFGPass : public ModulePass {
+    static char ID;
+    OurModuleCFGPass() : ModulePass(ID) {};
+
+    bool runOnModule(Module &M) override {
+        OurCFG::DumpModule(M, {Format, !NoBodies}, NumOfThreads);
+        return false;
+    }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
+};
+
+struct OurSimplifyCFGPass : public FunctionPass {
+    static char ID;
+    OurSimplifyCFGPass() : FunctionPass(ID) {};
+
+    bool runOnFunction(Function &F) override {
+        CFGSimplification Simplification;
+
+        bool Changed = Simplification.Run(F);
+        if (Changed)
+            Simplification.PrintStatistics(errs(), F);
+
+        return Changed;
+    }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
+};
+
+// Raspored blokova po ucestanosti izvrsavanja (iz branch_weights ili procenjenoj)
+struct OurBlockPlacementPass : public FunctionPass {
+    static char ID;
+    OurBlockPlacementPass() : FunctionPass(ID) {};
+
+    bool runOnFunction(Function &F) override {
+        BlockPlacement Placement;
+        Placement.SetColdRatio(ColdRatio);
+
+        bool Changed = Placement.Run(F);
+        if (Changed)
+            Placement.PrintStatistics(errs(), F);
+
+        return Changed;
+    }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
+};
+
+// Brojaci grana za profil; program se linkuje sa runtime/EdgeProfileRuntime.c
+struct OurEdgeProfilePass : public ModulePass {
+    static char ID;
+    OurEdgeProfilePass() : ModulePass(ID) {};
+
+    bool runOnModule(Module &M) override {
+        return EdgeProfile::InstrumentModule(M);
+    }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
+};
+
+// Profil iz fajla postaje branch_weights (i broj poziva funkcije), koje koristi -our-block-placement
+struct OurEdgeProfileUsePass : public FunctionPass {
+    static char ID;
+    std::map<std::string, EdgeProfile::FunctionProfile> Profiles;
+    OurEdgeProfileUsePass() : FunctionPass(ID) {};
+
+    bool doInitialization(Module &M) override {
+        std::string Error;
+        if (!EdgeProfile::ReadFile(ProfileFile, Profiles, Error))
+            errs() << Error << "\n";
+        return false;
+    }
+
+    bool runOnFunction(Function &F) override {
+        auto Profile = Profiles.find(F.getName().str());
+        if (Profile == Profiles.end())
+            return false;
+
+        EdgeProfile Edges;
+        std::string Error;
+        Edges.Create(F);
+        if (!Edges.Annotate(Profile->second, Error)) {
+            errs() << Error << "\n";
+            return false;
+        }
+
+        Edges.PrintStatistics(errs());
+        return true;
+    }
+
+    bool doFinalization(Module &M) override {
+        DenseCFG::Clear();
+        return false;
+    }
 };
 }
 
 char OurCFGPass::ID = 0;
-static RegisterPass<OurCFGPass> X("print-our-cfg", "Simple pass that prints CFG.");
\ No newline at end of file
+static RegisterPass<OurCFGPass> X("print-our-cfg", "Simple pass that prints CFG.");
+
+char OurModuleCFGPass::ID = 0;
+static RegisterPass<OurModuleCFGPass> Y("print-our-cfgs", "Prints CFGs of all functions in parallel.");
+
+char OurSimplifyCFGPass::ID = 0;
+static RegisterPass<OurSimplifyCFGPass> Z("our-simplify-cfg", "Merges, forwards and threads basic blocks.");
+
+char OurBlockPlacementPass::ID = 0;
+static RegisterPass<OurBlockPlacementPass> W("our-block-placement", "Orders basic blocks by their execution frequency.");
+
+char OurEdgeProfilePass::ID = 0;
+static RegisterPass<OurEdgeProfilePass> V("our-edge-profile", "Instruments the edges needed for an edge profile.");
+
+char OurEdgeProfileUsePass::ID = 0;
+static RegisterPass<OurEdgeProfileUsePass> U("our-edge-profile-use", "Attaches edge profile counts as branch weights.");
\ No newline at end of file
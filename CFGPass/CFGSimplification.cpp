@@ -0,0 +1,341 @@
+#include "CFGSimplification.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <vector>
+
+static unsigned CountEdges(BasicBlock *From, BasicBlock *To)
+{
+    return std::count(succ_begin(From), succ_end(From), To);
+}
+
+static bool IsPredecessor(BasicBlock *Predecessor, BasicBlock *BB)
+{
+    return std::find(pred_begin(BB), pred_end(BB), Predecessor) != pred_end(BB);
+}
+
+// Prethodnici bez ponavljanja, redom kojim ih daje lista upotreba bloka (isti pri svakom pokretanju)
+static std::vector<BasicBlock*> GetUniquePredecessors(BasicBlock *BB)
+{
+    std::vector<BasicBlock*> Predecessors;
+    std::unordered_set<BasicBlock*> Seen;
+    for (BasicBlock* Predecessor : predecessors(BB))
+        if (Seen.insert(Predecessor).second)
+            Predecessors.push_back(Predecessor);
+    return Predecessors;
+}
+
+// Samo skokovi cije se grane menjaju prostom zamenom successora (ne invoke, indirectbr, callbr)
+static bool HasSimpleTerminator(BasicBlock *BB)
+{
+    Instruction* Terminator = BB->getTerminator();
+    return Terminator != nullptr && (isa<BranchInst>(Terminator) || isa<SwitchInst>(Terminator));
+}
+
+void CFGSimplification::EraseBlock(BasicBlock *BB)
+{
+    Erased.insert(BB);
+    BB->eraseFromParent();
+}
+
+// Svaka grana osim jedne ka Target-u se brise, pa se iz phi cvorova tih successora uklanja po
+// jedan ulaz iz BB-a za svaku obrisanu granu
+void CFGSimplification::ReplaceTerminatorWithBranch(BasicBlock *BB, BasicBlock *Target)
+{
+    Instruction* Terminator = BB->getTerminator();
+    bool Kept = false;
+
+    for (unsigned i = 0; i < Terminator->getNumSuccessors(); ++i) {
+        BasicBlock* Successor = Terminator->getSuccessor(i);
+        if (Successor == Target && !Kept) {
+            Kept = true;
+            continue;
+        }
+        Successor->removePredecessor(BB);
+    }
+
+    Value* Condition = nullptr;
+    if (auto* Branch = dyn_cast<BranchInst>(Terminator))
+        Condition = Branch->getCondition();
+    else if (auto* Switch = dyn_cast<SwitchInst>(Terminator))
+        Condition = Switch->getCondition();
+
+    BranchInst::Create(Target, Terminator);
+    Terminator->eraseFromParent();
+
+    // Uslov koji se vise nigde ne koristi se brise, ako nema sporednih efekata
+    auto* ConditionInstruction = dyn_cast_or_null<Instruction>(Condition);
+    if (ConditionInstruction && ConditionInstruction->use_empty() && !ConditionInstruction->mayHaveSideEffects() &&
+        !isa<PHINode>(ConditionInstruction))
+        ConditionInstruction->eraseFromParent();
+}
+
+bool CFGSimplification::FoldTerminator(BasicBlock *BB)
+{
+    Instruction* Terminator = BB->getTerminator();
+    BasicBlock* Target = nullptr;
+
+    if (auto* Branch = dyn_cast_or_null<BranchInst>(Terminator)) {
+        if (Branch->isUnconditional())
+            return false;
+
+        if (Branch->getSuccessor(0) == Branch->getSuccessor(1))
+            Target = Branch->getSuccessor(0);
+        else if (auto* Condition = dyn_cast<ConstantInt>(Branch->getCondition()))
+            Target = Branch->getSuccessor(Condition->isZero() ? 1 : 0);
+    } else if (auto* Switch = dyn_cast_or_null<SwitchInst>(Terminator)) {
+        if (auto* Condition = dyn_cast<ConstantInt>(Switch->getCondition())) {
+            Target = Switch->findCaseValue(Condition)->getCaseSuccessor();
+        } else if (std::all_of(succ_begin(BB), succ_end(BB),
+                               [Switch](BasicBlock* Successor) { return Successor == Switch->getDefaultDest(); })) {
+            Target = Switch->getDefaultDest();
+        }
+    }
+
+    if (Target == nullptr)
+        return false;
+
+    ReplaceTerminatorWithBranch(BB, Target);
+    NumOfFolded++;
+    return true;
+}
+
+// Vrednost uslova skoka iz BB-a kada se u BB udje iz Predecessor-a, ili nullptr ako nije poznata
+ConstantInt* CFGSimplification::GetKnownCondition(BasicBlock *BB, BasicBlock *Predecessor)
+{
+    Value* Condition = cast<BranchInst>(BB->getTerminator())->getCondition();
+
+    auto* Phi = dyn_cast<PHINode>(Condition);
+    if (Phi != nullptr && Phi->getParent() == BB)
+        return dyn_cast<ConstantInt>(Phi->getIncomingValueForBlock(Predecessor));
+
+    auto* PredecessorBranch = dyn_cast<BranchInst>(Predecessor->getTerminator());
+    if (PredecessorBranch == nullptr || PredecessorBranch->isUnconditional() ||
+        PredecessorBranch->getCondition() != Condition ||
+        PredecessorBranch->getSuccessor(0) == PredecessorBranch->getSuccessor(1))
+        return nullptr;
+
+    LLVMContext &Context = BB->getContext();
+    return PredecessorBranch->getSuccessor(0) == BB ? ConstantInt::getTrue(Context) : ConstantInt::getFalse(Context);
+}
+
+// BB sadrzi samo phi cvorove i uslovni skok. Prethodnik za koji je uslov poznat preusmerava se na
+// successor koji bi skok izabrao, a phi cvorovi tog successora dobijaju ulaz iz prethodnika (ako je
+// vrednost iz BB-a bila phi iz BB-a, uzima se njen ulaz iz prethodnika). Zato phi cvorovi iz BB-a
+// smeju da se koriste samo u skoku i u phi cvorovima successora, i to za ulaz iz BB-a.
+bool CFGSimplification::ThreadJumps(BasicBlock *BB)
+{
+    auto* Branch = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+    if (Branch == nullptr || Branch->isUnconditional() || BB->isEntryBlock() || BB->hasAddressTaken())
+        return false;
+
+    for (Instruction &Instr : *BB) {
+        if (&Instr == Branch)
+            break;
+
+        auto* Phi = dyn_cast<PHINode>(&Instr);
+        if (Phi == nullptr)
+            return false;
+
+        for (Use &U : Phi->uses()) {
+            auto* User = cast<Instruction>(U.getUser());
+            auto* UserPhi = dyn_cast<PHINode>(User);
+
+            if (User == Branch)
+                continue;
+            if (UserPhi == nullptr || UserPhi->getParent() == BB || UserPhi->getIncomingBlock(U) != BB)
+                return false;
+        }
+    }
+
+    bool Changed = false;
+    for (BasicBlock* Predecessor : GetUniquePredecessors(BB)) {
+        if (Predecessor == BB || !HasSimpleTerminator(Predecessor) || CountEdges(Predecessor, BB) != 1)
+            continue;
+
+        ConstantInt* Condition = GetKnownCondition(BB, Predecessor);
+        if (Condition == nullptr)
+            continue;
+
+        BasicBlock* Target = Branch->getSuccessor(Condition->isZero() ? 1 : 0);
+        if (Target == BB || IsPredecessor(Predecessor, Target) || !Threaded.insert({Predecessor, BB}).second)
+            continue;
+
+        for (PHINode &Phi : Target->phis()) {
+            Value* Incoming = Phi.getIncomingValueForBlock(BB);
+            auto* IncomingPhi = dyn_cast<PHINode>(Incoming);
+            if (IncomingPhi != nullptr && IncomingPhi->getParent() == BB)
+                Incoming = IncomingPhi->getIncomingValueForBlock(Predecessor);
+
+            Phi.addIncoming(Incoming, Predecessor);
+        }
+
+        Predecessor->getTerminator()->replaceSuccessorWith(BB, Target);
+        BB->removePredecessor(Predecessor, true);
+        NumOfThreaded++;
+        Changed = true;
+    }
+
+    return Changed;
+}
+
+// Prazan blok (samo br label %S) se preskace: svaki prethodnik skace direktno na S, a phi cvorovi
+// u S dobijaju za njega vrednost koju su imali za prazan blok. Prethodnik koji je vec prethodnik
+// od S se preusmerava samo ako su mu vrednosti u phi cvorovima iste.
+bool CFGSimplification::ForwardEmptyBlock(BasicBlock *BB)
+{
+    auto* Branch = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+    if (Branch == nullptr || Branch->isConditional() || &BB->front() != Branch || BB->isEntryBlock() ||
+        BB->hasAddressTaken())
+        return false;
+
+    BasicBlock* Successor = Branch->getSuccessor(0);
+    if (Successor == BB)
+        return false;
+
+    bool Changed = false;
+    for (BasicBlock* Predecessor : GetUniquePredecessors(BB)) {
+        if (!HasSimpleTerminator(Predecessor))
+            continue;
+
+        if (IsPredecessor(Predecessor, Successor)) {
+            bool SameValues = true;
+            for (PHINode &Phi : Successor->phis())
+                SameValues = SameValues && Phi.getIncomingValueForBlock(Predecessor) == Phi.getIncomingValueForBlock(BB);
+            if (!SameValues)
+                continue;
+        }
+
+        unsigned NumOfEdges = CountEdges(Predecessor, BB);
+        for (PHINode &Phi : Successor->phis()) {
+            Value* Incoming = Phi.getIncomingValueForBlock(BB);
+            for (unsigned i = 0; i < NumOfEdges; ++i)
+                Phi.addIncoming(Incoming, Predecessor);
+        }
+
+        Predecessor->getTerminator()->replaceSuccessorWith(BB, Successor);
+        Changed = true;
+    }
+
+    if (Changed)
+        NumOfForwarded++;
+
+    if (pred_empty(BB)) {
+        Successor->removePredecessor(BB);
+        EraseBlock(BB);
+    }
+
+    return Changed;
+}
+
+// BB se bezuslovno nastavlja u blok kome je jedini prethodnik, pa se instrukcije tog bloka
+// prebacuju na kraj BB-a (phi cvorovi sa jednim ulazom se zamenjuju tim ulazom)
+bool CFGSimplification::MergeWithSuccessor(BasicBlock *BB)
+{
+    auto* Branch = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+    if (Branch == nullptr || Branch->isConditional())
+        return false;
+
+    BasicBlock* Successor = Branch->getSuccessor(0);
+    if (Successor == BB || Successor->getSinglePredecessor() != BB || Successor->hasAddressTaken())
+        return false;
+
+    while (auto* Phi = dyn_cast<PHINode>(&Successor->front())) {
+        Phi->replaceAllUsesWith(Phi->getIncomingValue(0));
+        Phi->eraseFromParent();
+    }
+
+    Successor->replaceSuccessorsPhiUsesWith(BB);
+    Branch->eraseFromParent();
+    BB->getInstList().splice(BB->end(), Successor->getInstList());
+    EraseBlock(Successor);
+
+    NumOfMerged++;
+    return true;
+}
+
+// Isto kao u DeadCodeElimination: prvo se uklanjaju ulazi u phi cvorove zivih successora, zatim se
+// raskidaju veze, pa se tek onda blokovi brisu
+bool CFGSimplification::RemoveUnreachableBlocks(Function &F)
+{
+    std::shared_ptr<const DenseCFG> Graph = DenseCFG::Get(F);
+    DFSOrder<unsigned> Order(Graph->GetNumOfBlocks());
+    Order.Run(0u, [&Graph](unsigned Node) { return Graph->GetSuccessors(Node); });
+
+    std::vector<BasicBlock*> Unreachable;
+    for (unsigned Block = 0; Block < Graph->GetNumOfBlocks(); ++Block)
+        if (!Order.IsVisited(Block))
+            Unreachable.push_back(Graph->GetBlock(Block));
+
+    if (Unreachable.empty())
+        return false;
+
+    for (BasicBlock* BB : Unreachable) {
+        for (BasicBlock* Successor : successors(BB))
+            if (Order.IsVisited(Graph->GetIndex(Successor)))
+                Successor->removePredecessor(BB);
+    }
+
+    for (BasicBlock* BB : Unreachable)
+        BB->dropAllReferences();
+
+    for (BasicBlock* BB : Unreachable) {
+        for (Instruction &Instr : *BB)
+            if (!Instr.use_empty())
+                Instr.replaceAllUsesWith(UndefValue::get(Instr.getType()));
+    }
+
+    for (BasicBlock* BB : Unreachable)
+        EraseBlock(BB);
+
+    NumOfRemoved += Unreachable.size();
+    return true;
+}
+
+bool CFGSimplification::Run(Function &F)
+{
+    NumOfFolded = NumOfThreaded = NumOfForwarded = NumOfMerged = NumOfRemoved = 0;
+    Threaded.clear();
+    if (F.isDeclaration())
+        return false;
+
+    bool Changed = false;
+    bool Iterate = true;
+
+    // Svaka izmena moze da omoguci neku drugu (npr. preusmeravanje ostavi uslovni skok sa istim
+    // granama, ili blok bez prethodnika), pa se prolazi ponavljaju dok god se nesto menja
+    while (Iterate) {
+        Iterate = RemoveUnreachableBlocks(F);
+        Erased.clear();
+
+        std::vector<BasicBlock*> Blocks;
+        for (BasicBlock &BB : F)
+            Blocks.push_back(&BB);
+
+        for (BasicBlock* BB : Blocks) {
+            if (Erased.find(BB) != Erased.end())
+                continue;
+
+            Iterate |= FoldTerminator(BB);
+            Iterate |= ThreadJumps(BB);
+            while (MergeWithSuccessor(BB))
+                Iterate = true;
+            Iterate |= ForwardEmptyBlock(BB);
+        }
+
+        Changed |= Iterate;
+    }
+
+    return Changed;
+}
+
+void CFGSimplification::PrintStatistics(raw_ostream &Out, Function &F) const
+{
+    Out << "--- CFG simplification of '" << F.getName() << "': " << NumOfFolded << " branches folded, "
+        << NumOfThreaded << " jumps threaded, " << NumOfForwarded << " empty blocks forwarded, "
+        << NumOfMerged << " blocks merged, " << NumOfRemoved << " unreachable blocks removed ---\n";
+}
@@ -0,0 +1,46 @@
+#ifndef CFGSIMPLIFICATION_H
+#define CFGSIMPLIFICATION_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include <set>
+#include <unordered_set>
+#include <utility>
+
+using namespace llvm;
+
+// Pojednostavljivanje CFG-a, do fiksne tacke:
+//  - uslovni skok i switch sa konstantnim uslovom ili sa svim granama ka istom bloku postaju br
+//  - jump threading: ako je uslov skoka u bloku bez drugih instrukcija (osim phi) poznat na grani
+//    iz nekog prethodnika (phi sa konstantom za taj prethodnik, ili isti uslov kao u skoku
+//    prethodnika), prethodnik skace direktno na odgovarajuci successor
+//  - prazan blok (samo br) se preskace, prethodnici skacu direktno na njegov successor
+//  - blok sa jednim successorom, koji ima samo njega za prethodnika, spaja se sa tim successorom
+//  - nedostizni blokovi se brisu
+class CFGSimplification {
+private:
+    std::unordered_set<BasicBlock*> Erased;
+    // Grane (prethodnik, blok) kroz koje je vec preusmereno. Svaka se preusmerava najvise jednom, jer
+    // bi se inace u petlji od blokova koji granaju po istom uslovu preusmeravanje ponavljalo u krug.
+    std::set<std::pair<BasicBlock*, BasicBlock*>> Threaded;
+    unsigned NumOfFolded;
+    unsigned NumOfThreaded;
+    unsigned NumOfForwarded;
+    unsigned NumOfMerged;
+    unsigned NumOfRemoved;
+
+    void ReplaceTerminatorWithBranch(BasicBlock*, BasicBlock*);
+    bool FoldTerminator(BasicBlock*);
+    ConstantInt* GetKnownCondition(BasicBlock*, BasicBlock*);
+    bool ThreadJumps(BasicBlock*);
+    bool ForwardEmptyBlock(BasicBlock*);
+    bool MergeWithSuccessor(BasicBlock*);
+    bool RemoveUnreachableBlocks(Function&);
+    void EraseBlock(BasicBlock*);
+public:
+    bool Run(Function&);
+    void PrintStatistics(raw_ostream&, Function&) const;
+};
+
+#endif // CFGSIMPLIFICATION_H
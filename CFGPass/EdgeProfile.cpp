@@ -0,0 +1,441 @@
+#include "EdgeProfile.h"
+#include "BlockFrequency.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+// Zaglavlje fajla sa profilom, isto kao u runtime/EdgeProfileRuntime.c
+static const char ProfileMagic[4] = {'O', 'E', 'P', '1'};
+
+void EdgeProfile::Create(Function &F)
+{
+    CFG.CreateCFG(F);
+    Graph = CFG.GetGraph();
+    Func = &F;
+
+    ComputeHash();
+    BuildEdges();
+    BuildSpanningTree();
+}
+
+// FNV-1a nad brojem blokova i indeksima successora svakog bloka
+void EdgeProfile::ComputeHash()
+{
+    Hash = 14695981039346656037ULL;
+    auto Add = [this](uint64_t Value) {
+        Hash ^= Value;
+        Hash *= 1099511628211ULL;
+    };
+
+    Add(Graph->GetNumOfBlocks());
+    for (unsigned Block = 0; Block < Graph->GetNumOfBlocks(); ++Block) {
+        ArrayRef<unsigned> Successors = Graph->GetSuccessors(Block);
+        Add(Successors.size());
+        for (unsigned Successor : Successors)
+            Add(Successor);
+    }
+}
+
+bool EdgeProfile::CanInstrument(unsigned From, unsigned To) const
+{
+    if (To == Graph->GetNumOfBlocks())
+        return true;
+
+    BasicBlock* FromBB = Graph->GetBlock(From);
+    BasicBlock* ToBB = Graph->GetBlock(To);
+    if (FromBB->getUniqueSuccessor() == ToBB)
+        return true;
+    if (ToBB->getUniquePredecessor() == FromBB && ToBB->getFirstInsertionPt() != ToBB->end())
+        return true;
+
+    Instruction* Terminator = FromBB->getTerminator();
+    return (isa<BranchInst>(Terminator) || isa<SwitchInst>(Terminator)) && !ToBB->isEHPad();
+}
+
+// Grane se prave samo za blokove dostizne iz ulaznog, jer su ostali uvek 0. Poslednja grana je
+// Exit -> ulaz.
+void EdgeProfile::BuildEdges()
+{
+    unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+    DFSOrder<unsigned> Order(NumOfBlocks);
+    Order.Run(0u, [this](unsigned Node) { return Graph->GetSuccessors(Node); });
+
+    Edges.clear();
+    EdgeOffsets.assign(NumOfBlocks + 2, 0);
+    for (unsigned Block = 0; Block < NumOfBlocks; ++Block) {
+        EdgeOffsets[Block] = Edges.size();
+        if (!Order.IsVisited(Block))
+            continue;
+
+        ArrayRef<unsigned> Successors = Graph->GetSuccessors(Block);
+        if (Successors.empty())
+            Edges.push_back({Block, NumOfBlocks, false, true, 0});
+
+        for (unsigned Index = 0; Index < Successors.size(); ++Index) {
+            unsigned Successor = Successors[Index];
+            if (std::find(Successors.begin(), Successors.begin() + Index, Successor) != Successors.begin() + Index)
+                continue;
+            Edges.push_back({Block, Successor, false, CanInstrument(Block, Successor), 0});
+        }
+    }
+
+    EdgeOffsets[NumOfBlocks] = Edges.size();
+    Edges.push_back({NumOfBlocks, 0, false, false, 0});
+    EdgeOffsets[NumOfBlocks + 1] = Edges.size();
+}
+
+// Kruskal za maksimalno razapinjuce stablo: prvo grane koje moraju u stablo, pa ostale od najcesce
+// izvrsavane. Ako grana koja mora u stablo zatvara ciklus sa takvim granama, ostaje bez brojaca i
+// njen broj ce biti 0.
+void EdgeProfile::BuildSpanningTree()
+{
+    unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+    BlockFrequency Frequency;
+    Frequency.Compute(Graph, false);
+
+    std::vector<double> Weights(Edges.size(), 0);
+    for (unsigned Index = 0; Index < Edges.size(); ++Index) {
+        const Edge &E = Edges[Index];
+        if (E.From == NumOfBlocks)
+            continue;
+
+        Weights[Index] = Frequency.GetFrequency(E.From);
+        for (const auto &Probability : Frequency.GetProbabilities(E.From))
+            if (Probability.first == E.To)
+                Weights[Index] *= Probability.second;
+    }
+
+    std::vector<unsigned> Sorted(Edges.size());
+    std::iota(Sorted.begin(), Sorted.end(), 0);
+    std::stable_sort(Sorted.begin(), Sorted.end(), [&](unsigned A, unsigned B) {
+        if (Edges[A].CanInstrument != Edges[B].CanInstrument)
+            return !Edges[A].CanInstrument;
+        return Weights[A] > Weights[B];
+    });
+
+    std::vector<unsigned> Leader(NumOfBlocks + 1);
+    std::iota(Leader.begin(), Leader.end(), 0);
+    auto Find = [&Leader](unsigned Node) {
+        while (Leader[Node] != Node)
+            Node = Leader[Node] = Leader[Leader[Node]];
+        return Node;
+    };
+
+    Counters.clear();
+    for (unsigned Index : Sorted) {
+        unsigned From = Find(Edges[Index].From);
+        unsigned To = Find(Edges[Index].To);
+        if (From != To) {
+            Leader[From] = To;
+            Edges[Index].InTree = true;
+        }
+    }
+
+    for (unsigned Index = 0; Index < Edges.size(); ++Index)
+        if (!Edges[Index].InTree)
+            Counters.push_back(Index);
+}
+
+Instruction* EdgeProfile::GetCounterPosition(const Edge &E)
+{
+    if (!E.CanInstrument)
+        return nullptr;
+
+    BasicBlock* From = Graph->GetBlock(E.From);
+    if (E.To == Graph->GetNumOfBlocks())
+        return From->getTerminator();
+
+    BasicBlock* To = Graph->GetBlock(E.To);
+    if (From->getUniqueSuccessor() == To)
+        return From->getTerminator();
+    if (To->getUniquePredecessor() == From && To->getFirstInsertionPt() != To->end())
+        return &*To->getFirstInsertionPt();
+
+    Instruction* Terminator = From->getTerminator();
+    unsigned SuccessorIndex = 0;
+    while (Terminator->getSuccessor(SuccessorIndex) != To)
+        SuccessorIndex++;
+
+    BasicBlock* Split = SplitCriticalEdge(Terminator, SuccessorIndex,
+                                          CriticalEdgeSplittingOptions().setMergeIdenticalEdges());
+    if (Split == nullptr)
+        return nullptr;
+
+    NumOfSplit++;
+    return Split->getTerminator();
+}
+
+// Brojac je i64 u nizu Counters, uvecava se bez atomicnih operacija (program sa vise niti moze da
+// izgubi poneko uvecanje).
+bool EdgeProfile::Instrument(GlobalVariable *CounterArray)
+{
+    Type* Int64Ty = Type::getInt64Ty(Func->getContext());
+    NumOfSplit = 0;
+
+    for (unsigned Index = 0; Index < Counters.size(); ++Index) {
+        Instruction* Position = GetCounterPosition(Edges[Counters[Index]]);
+        if (Position == nullptr)
+            continue;
+
+        IRBuilder<> Builder(Position);
+        Value* Pointer = Builder.CreateConstInBoundsGEP2_64(CounterArray->getValueType(), CounterArray, 0, Index);
+        Value* Count = Builder.CreateLoad(Int64Ty, Pointer);
+        Builder.CreateStore(Builder.CreateAdd(Count, ConstantInt::get(Int64Ty, 1)), Pointer);
+    }
+
+    return !Counters.empty();
+}
+
+// Brojevi grana stabla iz brojeva ostalih grana: cvor kome je nepoznata jos samo jedna grana
+// odredjuje je iz zbira ulaznih i izlaznih grana. Nepoznate grane cine sumu (stablo bez grana sa
+// brojacima), pa uvek postoji takav cvor (list) dok ima nepoznatih.
+bool EdgeProfile::ComputeCounts(ArrayRef<uint64_t> Counts)
+{
+    unsigned NumOfNodes = Graph->GetNumOfBlocks() + 1;
+    std::vector<std::vector<unsigned>> Incident(NumOfNodes);
+    std::vector<unsigned> NumOfUnknown(NumOfNodes, 0);
+    std::vector<bool> Known(Edges.size(), true);
+
+    for (unsigned Index = 0; Index < Counters.size(); ++Index)
+        Edges[Counters[Index]].Count = Counts[Index];
+
+    for (unsigned Index = 0; Index < Edges.size(); ++Index) {
+        Edge &E = Edges[Index];
+        Incident[E.From].push_back(Index);
+        if (E.To != E.From)
+            Incident[E.To].push_back(Index);
+
+        if (E.InTree) {
+            Known[Index] = false;
+            NumOfUnknown[E.From]++;
+            NumOfUnknown[E.To]++;
+        }
+    }
+
+    std::vector<unsigned> Worklist;
+    for (unsigned Node = 0; Node < NumOfNodes; ++Node)
+        if (NumOfUnknown[Node] == 1)
+            Worklist.push_back(Node);
+
+    while (!Worklist.empty()) {
+        unsigned Node = Worklist.back();
+        Worklist.pop_back();
+        if (NumOfUnknown[Node] != 1)
+            continue;
+
+        int64_t Balance = 0;
+        int Unknown = -1;
+        for (unsigned Index : Incident[Node]) {
+            if (!Known[Index]) {
+                Unknown = Index;
+                continue;
+            }
+            if (Edges[Index].To == Node)
+                Balance += Edges[Index].Count;
+            if (Edges[Index].From == Node)
+                Balance -= Edges[Index].Count;
+        }
+
+        Edge &E = Edges[Unknown];
+        E.Count = E.To == Node ? -Balance : Balance;
+        Known[Unknown] = true;
+
+        unsigned Other = E.To == Node ? E.From : E.To;
+        NumOfUnknown[Node]--;
+        if (--NumOfUnknown[Other] == 1)
+            Worklist.push_back(Other);
+    }
+
+    return std::all_of(Known.begin(), Known.end(), [](bool K) { return K; });
+}
+
+// Svaki successor skoka dobija broj svoje grane; kada vise successora vodi u isti blok, broj
+// dobija prvi, a ostali 0. branch_weights su 32-bitni, pa se veliki brojevi srazmerno smanjuju.
+bool EdgeProfile::Annotate(const FunctionProfile &Profile, std::string &Error)
+{
+    if (Profile.Hash != Hash || Profile.Counts.size() != Counters.size()) {
+        Error = "Profile of '" + Func->getName().str() + "' does not match its CFG";
+        return false;
+    }
+    if (!ComputeCounts(Profile.Counts)) {
+        Error = "Edge counts of '" + Func->getName().str() + "' cannot be computed";
+        return false;
+    }
+
+    MDBuilder Builder(Func->getContext());
+    NumOfAnnotated = 0;
+    for (unsigned Block = 0; Block < Graph->GetNumOfBlocks(); ++Block) {
+        Instruction* Terminator = Graph->GetBlock(Block)->getTerminator();
+        if (EdgeOffsets[Block] == EdgeOffsets[Block + 1] || Terminator->getNumSuccessors() < 2 ||
+            !(isa<BranchInst>(Terminator) || isa<SwitchInst>(Terminator)))
+            continue;
+
+        std::vector<uint64_t> Counts;
+        for (unsigned Index = 0; Index < Terminator->getNumSuccessors(); ++Index) {
+            BasicBlock* Successor = Terminator->getSuccessor(Index);
+            bool First = true;
+            for (unsigned Previous = 0; Previous < Index; ++Previous)
+                First &= Terminator->getSuccessor(Previous) != Successor;
+
+            uint64_t Count = 0;
+            for (unsigned E = EdgeOffsets[Block]; First && E < EdgeOffsets[Block + 1]; ++E)
+                if (Graph->GetBlock(Edges[E].To) == Successor)
+                    Count = std::max<int64_t>(Edges[E].Count, 0);
+            Counts.push_back(Count);
+        }
+
+        uint64_t Max = *std::max_element(Counts.begin(), Counts.end());
+        uint64_t Scale = Max / UINT32_MAX + 1;
+        std::vector<uint32_t> Weights;
+        for (uint64_t Count : Counts)
+            Weights.push_back(Count / Scale);
+
+        Terminator->setMetadata(LLVMContext::MD_prof, Builder.createBranchWeights(Weights));
+        NumOfAnnotated++;
+    }
+
+    Func->setEntryCount(std::max<int64_t>(Edges.back().Count, 0));
+    Annotated = true;
+    return true;
+}
+
+void EdgeProfile::PrintStatistics(raw_ostream &Out) const
+{
+    Out << "--- Edge profile of '" << Func->getName() << "': ";
+    if (Annotated)
+        Out << "entry count " << std::max<int64_t>(Edges.back().Count, 0) << ", " << NumOfAnnotated
+            << " branches annotated ---\n";
+    else
+        Out << Counters.size() << " counters on " << Edges.size() << " edges, " << NumOfSplit
+            << " critical edges split ---\n";
+}
+
+// Za svaku funkciju sa telom: niz brojaca i opis { Next, Name, Hash, NumOfCounters, Counters },
+// koji konstruktor modula prijavljuje runtime-u (__our_edge_profile_register). Runtime na izlasku
+// iz programa upisuje sve prijavljene funkcije u fajl.
+bool EdgeProfile::InstrumentModule(Module &M)
+{
+    LLVMContext &Context = M.getContext();
+    Type* Int8PtrTy = Type::getInt8PtrTy(Context);
+    Type* Int32Ty = Type::getInt32Ty(Context);
+    Type* Int64Ty = Type::getInt64Ty(Context);
+    StructType* DescriptorTy = StructType::get(Context, {Int8PtrTy, Int8PtrTy, Int64Ty, Int32Ty, Int8PtrTy});
+
+    std::vector<Function*> Functions;
+    for (Function &F : M)
+        if (!F.isDeclaration() && !F.getName().startswith("__our_edge_profile"))
+            Functions.push_back(&F);
+    if (Functions.empty())
+        return false;
+
+    std::vector<GlobalVariable*> Descriptors;
+    for (Function* F : Functions) {
+        EdgeProfile Profile;
+        Profile.Create(*F);
+
+        ArrayType* CountersTy = ArrayType::get(Int64Ty, Profile.GetNumOfCounters());
+        GlobalVariable* Counters = new GlobalVariable(M, CountersTy, false, GlobalValue::PrivateLinkage,
+                                                      Constant::getNullValue(CountersTy),
+                                                      "__our_edge_profile_counters." + F->getName());
+        Profile.Instrument(Counters);
+
+        Constant* NameText = ConstantDataArray::getString(Context, F->getName());
+        GlobalVariable* Name = new GlobalVariable(M, NameText->getType(), true, GlobalValue::PrivateLinkage,
+                                                  NameText, "__our_edge_profile_name." + F->getName());
+        Name->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+
+        Constant* Descriptor = ConstantStruct::get(DescriptorTy, {
+            Constant::getNullValue(Int8PtrTy),
+            ConstantExpr::getPointerCast(Name, Int8PtrTy),
+            ConstantInt::get(Int64Ty, Profile.GetHash()),
+            ConstantInt::get(Int32Ty, Profile.GetNumOfCounters()),
+            ConstantExpr::getPointerCast(Counters, Int8PtrTy)});
+        Descriptors.push_back(new GlobalVariable(M, DescriptorTy, false, GlobalValue::PrivateLinkage, Descriptor,
+                                                 "__our_edge_profile_function." + F->getName()));
+
+        Profile.PrintStatistics(errs());
+    }
+
+    FunctionCallee Register = M.getOrInsertFunction("__our_edge_profile_register", Type::getVoidTy(Context),
+                                                    Int8PtrTy);
+    Function* Init = Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                                      GlobalValue::InternalLinkage, "__our_edge_profile_init", M);
+    IRBuilder<> Builder(BasicBlock::Create(Context, "entry", Init));
+    for (GlobalVariable* Descriptor : Descriptors)
+        Builder.CreateCall(Register, {ConstantExpr::getPointerCast(Descriptor, Int8PtrTy)});
+    Builder.CreateRetVoid();
+
+    appendToGlobalCtors(M, Init, 0);
+    return true;
+}
+
+// Format fajla (brojevi u redosledu bajtova masine koja je izvrsavala program):
+//   "OEP1", u32 broj funkcija
+//   za svaku funkciju: u32 duzina imena, ime, u64 hes CFG-a, u32 broj brojaca, u64 brojaci
+// Funkcije se prepoznaju po imenu.
+bool EdgeProfile::ReadFile(const std::string &FileName, std::map<std::string, FunctionProfile> &Profiles,
+                           std::string &Error)
+{
+    std::FILE* File = std::fopen(FileName.c_str(), "rb");
+    if (File == nullptr) {
+        Error = "Could not open " + FileName;
+        return false;
+    }
+
+    std::vector<char> Data;
+    char Buffer[1 << 16];
+    size_t Size;
+    while ((Size = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+        Data.insert(Data.end(), Buffer, Buffer + Size);
+    std::fclose(File);
+
+    size_t Position = 0;
+    auto Read = [&](void *Destination, size_t Length) {
+        if (Data.size() - Position < Length)
+            return false;
+        std::memcpy(Destination, Data.data() + Position, Length);
+        Position += Length;
+        return true;
+    };
+
+    char Magic[4];
+    uint32_t NumOfFunctions;
+    if (!Read(Magic, 4) || std::memcmp(Magic, ProfileMagic, 4) != 0 || !Read(&NumOfFunctions, 4)) {
+        Error = FileName + " is not an edge profile";
+        return false;
+    }
+
+    for (uint32_t Index = 0; Index < NumOfFunctions; ++Index) {
+        uint32_t NameLength;
+        std::string Name;
+        FunctionProfile Profile;
+        uint32_t NumOfCounters;
+
+        bool Valid = Read(&NameLength, 4) && NameLength <= Data.size() - Position;
+        if (Valid) {
+            Name.assign(Data.data() + Position, NameLength);
+            Position += NameLength;
+            Valid = Read(&Profile.Hash, 8) && Read(&NumOfCounters, 4) &&
+                    NumOfCounters <= (Data.size() - Position) / 8;
+        }
+        if (!Valid) {
+            Error = FileName + " is truncated";
+            return false;
+        }
+
+        Profile.Counts.resize(NumOfCounters);
+        Read(Profile.Counts.data(), NumOfCounters * 8);
+        Profiles[Name] = std::move(Profile);
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef EDGEPROFILE_H
+#define EDGEPROFILE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Module.h"
+#include "OurCFG.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Profil grana sa minimalnim brojem brojaca (Knuth, Ball-Larus):
+//  - graf je CFG funkcije (dostizni blokovi) sa jos jednim cvorom Exit: svaki blok bez successora
+//    ima granu ka Exit-u, a Exit ima granu ka ulaznom bloku (broj poziva funkcije)
+//  - za svaki cvor zbir ulaznih grana jednak je zbiru izlaznih, pa su brojevi grana jednog
+//    razapinjuceg stabla (bez smera) odredjeni brojevima ostalih grana. Brojaci su samo na granama
+//    van stabla, a stablo je maksimalno po proceni ucestanosti (BlockFrequency bez metapodataka),
+//    pa su brojaci na retko izvrsavanim granama
+//  - grana Exit -> ulaz i grane koje se ne mogu instrumentisati (npr. iz indirectbr u blok sa vise
+//    prethodnika) su uvek u stablu
+//  - brojac grane je na kraju izvora ako izvor ima samo tog successora, na pocetku odredista ako
+//    odrediste ima samo tog prethodnika, a inace se grana deli novim blokom (kriticna grana)
+// Vise grana izmedju istih blokova (npr. case-ovi switch-a) je jedna grana. Stablo zavisi samo od
+// oblika CFG-a, pa instrumentacija i citanje profila nad istim IR-om daju iste brojace; to se
+// proverava hesom CFG-a koji se upisuje u profil.
+class EdgeProfile {
+private:
+    struct Edge {
+        unsigned From;
+        unsigned To;            // Exit je cvor GetNumOfBlocks()
+        bool InTree;
+        bool CanInstrument;
+        int64_t Count;
+    };
+
+    OurCFG CFG;
+    std::shared_ptr<const DenseCFG> Graph;
+    Function* Func = nullptr;
+    std::vector<Edge> Edges;
+    // Grane bloka su Edges[EdgeOffsets[i] .. EdgeOffsets[i + 1])
+    std::vector<unsigned> EdgeOffsets;
+    std::vector<unsigned> Counters;
+    uint64_t Hash;
+    unsigned NumOfSplit = 0;
+    bool Annotated = false;
+    unsigned NumOfAnnotated = 0;
+
+    void BuildEdges();
+    void BuildSpanningTree();
+    void ComputeHash();
+    bool CanInstrument(unsigned, unsigned) const;
+    Instruction* GetCounterPosition(const Edge&);
+    bool ComputeCounts(ArrayRef<uint64_t>);
+public:
+    // Profil jedne funkcije, kako ga upisuje runtime (runtime/EdgeProfileRuntime.c)
+    struct FunctionProfile {
+        uint64_t Hash;
+        std::vector<uint64_t> Counts;
+    };
+
+    void Create(Function&);
+    uint64_t GetHash() const { return Hash; }
+    unsigned GetNumOfCounters() const { return Counters.size(); }
+    unsigned GetNumOfEdges() const { return Edges.size(); }
+
+    bool Instrument(GlobalVariable*);
+    bool Annotate(const FunctionProfile&, std::string &Error);
+    void PrintStatistics(raw_ostream&) const;
+
+    static bool InstrumentModule(Module&);
+    static bool ReadFile(const std::string &FileName, std::map<std::string, FunctionProfile>&, std::string &Error);
+};
+
+#endif // EDGEPROFILE_H
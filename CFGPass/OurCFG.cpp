@@ -1,111 +1,165 @@
 #include "OurCFG.h"
+#include "../Graph/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
 
-void OurCFG::AddEdge(BasicBlock* From, BasicBlock* To)
-{
-    AdjacencyList[From].push_back(To);
-}
+#include <mutex>
 
-// Analogno successorima, postoje i predecessori
+// Analogno successorima, postoje i predecessori. Oba su u zajednickom DenseCFG-u, koji se gradi
+// jednom po funkciji i deli sa ostalim pasovima.
 void OurCFG::CreateCFG(Function &F)
 {
     FunctionName = F.getName().str();
+    Func = &F;
+    Graph = DenseCFG::Get(F);
+}
+
+void OurCFG::SetExportOptions(const GraphExportOptions &NewOptions)
+{
+    Options = NewOptions;
+}
+
+std::string OurCFG::GetFileName() const
+{
+    return FunctionName + GetGraphFileExtension(Options.Format);
+}
 
-    // Krecemo se kroz sve BasicBlock-ove prosledjene funkcije
-    for (BasicBlock &BB : F) {
-        AdjacencyList[&BB] = {};
-        // successors - funkcija koja nam vraca sve BasicBlock-ove u koje mozemo skociti iz trenutnog BasicBlock-a
-        // uz koriscenje br instrukcije
-        for (BasicBlock* Successor : successors(&BB))
-            AddEdge(&BB, Successor);
+// Cvorovi su oznaceni indeksima iz DenseCFG-a, tj. redom kojim su blokovi u funkciji, pa je izlaz
+// isti pri svakom pokretanju. Imena blokova i instrukcije se ispisuju kroz jedan ModuleSlotTracker
+// za celu funkciju: printAsOperand i operator<< bez njega za svaki poziv ponovo numerisu sve
+// neimenovane vrednosti funkcije, pa je ispis velike funkcije kvadratan.
+void OurCFG::Export(GraphExporter &Exporter)
+{
+    ModuleSlotTracker Slots(Func->getParent());
+    Slots.incorporateFunction(*Func);
+
+    std::string Name;
+    std::string Body;
+    for (unsigned Index = 0; Index < Graph->GetNumOfBlocks(); ++Index)
+        ExportBasicBlock(Index, Exporter, Slots, Name, Body);
+}
+
+void OurCFG::DumpToFile()
+{
+    GraphExporter Exporter(Options, "CFG for '" + FunctionName + "' function", {"#b70d28ff", "#b70d2870"});
+    std::string Error;
+
+    if (!Exporter.Open(GetFileName(), Error)) {
+        errs() << Error << "\n";
+        return;
     }
+
+    Export(Exporter);
+    if (!Exporter.Close(Error))
+        errs() << Error << "\n";
 }
 
-void OurCFG::DumpToFile() 
+std::string OurCFG::ExportToString()
 {
-    std::error_code error;
-    std::string FileName = FunctionName + ".dot";
-    raw_fd_stream File(FileName, error);
-
-    File << "digraph \"CFG for '" << FunctionName << "' function\" {\n"
-        "\tlabel=\"CFG for '" << FunctionName << "' function\";\n";
-    
-    for (auto &kvp : AdjacencyList)
-        DumpBasicBlock(kvp.first, File);
-    
-    File << "}\n";
-    File.close();
+    GraphExporter Exporter(Options, "CFG for '" + FunctionName + "' function", {"#b70d28ff", "#b70d2870"});
+    std::string Error;
+
+    Export(Exporter);
+    Exporter.Close(Error);
+    return Exporter.GetText();
 }
 
-void OurCFG::DumpBasicBlock(BasicBlock* BB, raw_fd_stream &File, bool only)
+// CFG-ovi svih funkcija modula. Grafovi se prave (DenseCFG) na niti koja poziva, a svaki posao u
+// svojoj niti ispisuje jednu funkciju u svoj bafer i upisuje svoj fajl, pa se fajlovi pisu
+// istovremeno. Sadrzaj fajla ne zavisi od broja niti: blokovi su redom kojim su u funkciji.
+void OurCFG::DumpModule(Module &M, const GraphExportOptions &Options, unsigned NumOfThreads)
 {
-    bool MultipleSuccessors = false;
+    std::vector<std::unique_ptr<OurCFG>> CFGs;
+    for (Function &F : M) {
+        if (F.isDeclaration())
+            continue;
+
+        CFGs.push_back(std::make_unique<OurCFG>());
+        CFGs.back()->CreateCFG(F);
+        CFGs.back()->SetExportOptions(Options);
+    }
 
-    File << "\tNode" << BB << " [shape=record, color=\"#b70d28ff\", style=filled, fillcolor=\"#b70d2870\", label=\"{";
-    BB->printAsOperand(File, false);
+    std::mutex ErrorsLock;
+    std::vector<std::string> Errors;
+    {
+        ThreadPool Workers(NumOfThreads);
 
-    if (only) {
-        File << "\\l ";
-        // Vrsimo proveru da li kontrola toka moze da nas dovede iz tekuceg BasicBlock-a u vise njih ili samo u jedan.
-        // Da bismo to utvrdili, neophodno je da proverimo da li BasicBlock kao instrukciju sadrzi br instrukciju koja se odnosi na 
-        // IF ili SWITCH naredbu. Ukoliko sadrzi, znamo da postoji vise successora i neophodno je adekvatno ih zapisati u .dot fajlu, 
-        // a ukoliko ne, zapisujemo instrukciju standardno.
+        for (auto &CFG : CFGs) {
+            OurCFG* Current = CFG.get();
 
-        for (Instruction &Instr : *BB) {
-            // Provera da li je u pitanju br instrukcija
-            if (BranchInst *BranchInstruction = dyn_cast<BranchInst>(&Instr)) {
-                // Provera da li je ova instrukcija IF
-                if (BranchInstruction->isConditional()) {
-                    MultipleSuccessors = true;
-
-                    // Grananje u .dot fajlu zapisujemo na ovaj nacin
-                    File << "|{<s0>T|<s1>F}";
-                } else {
-                    File << Instr << "\\l ";
-                }
-            }
-
-            if (SwitchInst *SwitchInstruction = dyn_cast<SwitchInst>(&Instr)) {
-                MultipleSuccessors = true;
-
-                // Zapisujemo prvo default slucaj
-                File << "|{<s0>def";
-
-                // Dalje prolazimo kroz svaki case i ispisujemo redni broj, a zatim i vrednost
-                for (auto Case : SwitchInstruction->cases()) {
-                    File << "|<s" << (Case.getCaseIndex() + 1) << ">";
-
-                    // Ispisujemo kao operand jer zelimo da izvucemo samo vrednost, a ne i tip podataka uz nju
-                    // U IR-u, switch ima narednu formu
-                    // switch i32 %num, label %num_l1 [
-                    //      i32 value_1, label %num_l2
-                    //      i32 value_2, label %num_l3
-                    //      ...   
-                    // ]
-                    // Napomena: u implementaciji SwitchInst, vrednosti koje su nama neophodne nalaze se na PARNIM indeksima.
-                    // Dodatno, prva dva indeksa treba preskociti jer se oni odnose na vrednost po kojoj granamo, kao i 
-                    // basic block na koji se skace u podrazumevanom slucaju. Nepadni indeksi se odnose na basic block-ove 
-                    // u koje dolazimo prilikom poklapanja.
-
-                    auto* SwitchOperand = SwitchInstruction->getOperand(2 * Case.getCaseIndex() + 2);
-                    SwitchOperand->printAsOperand(File, false);
-                }
-
-                File << "}";         
-            } else {
-                File << Instr << "\\l ";
-            }
+            Workers.Async([Current, &ErrorsLock, &Errors] {
+                std::string Error;
+                if (GraphExporter::WriteFile(Current->GetFileName(), Current->ExportToString(), Error))
+                    return;
+
+                std::lock_guard<std::mutex> Guard(ErrorsLock);
+                Errors.push_back(Error);
+            });
         }
+
+        Workers.Wait();
     }
 
-    File << "}\"];\n";
+    for (const std::string &Error : Errors)
+        errs() << Error << "\n";
+}
 
-    unsigned Index = 0;
-    for (auto Successor : AdjacencyList[BB]) {
-        if (MultipleSuccessors) {
-            File << "\tNode" << BB << ":s" << Index << " -> Node" << Successor << ";\n";
-            Index++;
-        } else {
-            File << "\tNode" << BB << " -> Node" << Successor << ";\n";
+void OurCFG::ExportBasicBlock(unsigned Index, GraphExporter &Exporter, ModuleSlotTracker &Slots,
+                              std::string &Name, std::string &Body)
+{
+    BasicBlock* BB = Graph->GetBlock(Index);
+    Instruction* Terminator = BB->getTerminator();
+    std::vector<std::string> Ports;
+
+    // Vrsimo proveru da li kontrola toka moze da nas dovede iz tekuceg BasicBlock-a u vise njih ili samo u jedan.
+    // Da bismo to utvrdili, neophodno je da proverimo da li je poslednja instrukcija br koja se odnosi na IF ili
+    // SWITCH naredba. Ukoliko jeste, ona se ne ispisuje, vec svaki successor dobija svoj izlaz iz cvora (T i F,
+    // odnosno def i vrednosti case-ova), a grane se vezuju za te izlaze.
+    BranchInst* BranchInstruction = dyn_cast_or_null<BranchInst>(Terminator);
+    SwitchInst* SwitchInstruction = dyn_cast_or_null<SwitchInst>(Terminator);
+
+    if (BranchInstruction && BranchInstruction->isConditional()) {
+        Ports = {"T", "F"};
+    } else if (SwitchInstruction) {
+        // U IR-u, switch ima narednu formu
+        // switch i32 %num, label %num_l1 [
+        //      i32 value_1, label %num_l2
+        //      i32 value_2, label %num_l3
+        //      ...
+        // ]
+        // Successori su redom podrazumevani slucaj pa case-ovi, isto kao izlazi.
+        Ports.push_back("def");
+        for (auto Case : SwitchInstruction->cases()) {
+            SmallString<16> Value;
+            Case.getCaseValue()->getValue().toStringSigned(Value);
+            Ports.push_back(Value.str().str());
         }
     }
-}
\ No newline at end of file
+
+    Name.clear();
+    raw_string_ostream NameStream(Name);
+    BB->printAsOperand(NameStream, false, Slots);
+    NameStream.flush();
+
+    Body.clear();
+    if (Exporter.GetBodies()) {
+        raw_string_ostream BodyStream(Body);
+
+        for (Instruction &Instr : *BB) {
+            if (&Instr == Terminator && !Ports.empty())
+                break;
+
+            Instr.print(BodyStream, Slots);
+            BodyStream << "\n";
+        }
+
+        BodyStream.flush();
+    }
+
+    Exporter.AddNode(Index, Name, Body, Ports);
+
+    int SuccessorIndex = 0;
+    for (unsigned Successor : Graph->GetSuccessors(Index)) {
+        Exporter.AddEdge(Index, Successor, Ports.empty() ? -1 : SuccessorIndex);
+        SuccessorIndex++;
+    }
+}
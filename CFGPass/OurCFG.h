@@ -2,8 +2,12 @@
 #define OURCFG_H
 
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/GraphExporter.h"
 
-#include <unordered_map>
+#include <memory>
 #include <vector>
 
 using namespace llvm;
@@ -13,14 +17,22 @@ using namespace llvm;
 
 class OurCFG {
 private:
-    std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> AdjacencyList;
+    std::shared_ptr<const DenseCFG> Graph;
     std::string FunctionName;
+    Function* Func = nullptr;
+    GraphExportOptions Options;
 
-    void DumpBasicBlock(BasicBlock*, raw_fd_stream &File, bool only = true);
+    void ExportBasicBlock(unsigned, GraphExporter&, ModuleSlotTracker&, std::string&, std::string&);
 public:
-    void AddEdge(BasicBlock*, BasicBlock*);
     void CreateCFG(Function&);
+    std::shared_ptr<const DenseCFG> GetGraph() const { return Graph; }
+    void SetExportOptions(const GraphExportOptions&);
+    std::string GetFileName() const;
+    void Export(GraphExporter&);
+    std::string ExportToString();
     void DumpToFile();
+
+    static void DumpModule(Module&, const GraphExportOptions&, unsigned NumOfThreads);
 };
 
 #endif // OURCFG_H
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Runtime za program instrumentisan sa -our-edge-profile. Linkuje se uz program, npr.
+//   opt -enable-new-pm=0 -load LLVMOurCFGPass.so -our-edge-profile program.ll -o program.bc
+//   clang program.bc runtime/EdgeProfileRuntime.c -o program
+// Konstruktor svakog instrumentisanog modula prijavljuje svoje funkcije, a na izlasku iz programa
+// se brojaci svih funkcija upisuju u fajl iz promenljive okruzenja OUR_EDGE_PROFILE (podrazumevano
+// edge_profile.bin). Svako pokretanje prepisuje fajl. Format cita EdgeProfile::ReadFile.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Isti raspored kao opis funkcije koji pravi EdgeProfile::InstrumentModule
+struct OurEdgeProfileFunction {
+    struct OurEdgeProfileFunction *Next;
+    const char *Name;
+    uint64_t Hash;
+    uint32_t NumOfCounters;
+    uint64_t *Counters;
+};
+
+static struct OurEdgeProfileFunction *Functions = NULL;
+
+static int WriteFunction(FILE *File, const struct OurEdgeProfileFunction *Function)
+{
+    uint32_t NameLength = strlen(Function->Name);
+
+    return fwrite(&NameLength, 4, 1, File) == 1 &&
+           fwrite(Function->Name, 1, NameLength, File) == NameLength &&
+           fwrite(&Function->Hash, 8, 1, File) == 1 &&
+           fwrite(&Function->NumOfCounters, 4, 1, File) == 1 &&
+           fwrite(Function->Counters, 8, Function->NumOfCounters, File) == Function->NumOfCounters;
+}
+
+static void DumpProfile(void)
+{
+    const char *FileName = getenv("OUR_EDGE_PROFILE");
+    if (FileName == NULL || FileName[0] == '\0')
+        FileName = "edge_profile.bin";
+
+    FILE *File = fopen(FileName, "wb");
+    if (File == NULL) {
+        fprintf(stderr, "edge profile: could not open %s\n", FileName);
+        return;
+    }
+
+    uint32_t NumOfFunctions = 0;
+    for (const struct OurEdgeProfileFunction *Function = Functions; Function != NULL; Function = Function->Next)
+        NumOfFunctions++;
+
+    int Written = fwrite("OEP1", 1, 4, File) == 4 && fwrite(&NumOfFunctions, 4, 1, File) == 1;
+    for (const struct OurEdgeProfileFunction *Function = Functions; Written && Function != NULL;
+         Function = Function->Next)
+        Written = WriteFunction(File, Function);
+
+    if (fclose(File) != 0 || !Written)
+        fprintf(stderr, "edge profile: could not write %s\n", FileName);
+}
+
+void __our_edge_profile_register(struct OurEdgeProfileFunction *Function)
+{
+    if (Functions == NULL)
+        atexit(DumpProfile);
+
+    Function->Next = Functions;
+    Functions = Function;
+}
@@ -1,12 +1,19 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "ourcallgraph.h"
 
 using namespace llvm;
 
+static cl::opt<GraphFormat> Format("call-graph-format", cl::init(GraphFormat::Dot),
+                                   cl::desc("Format of the call graph file"),
+                                   cl::values(clEnumValN(GraphFormat::Dot, "dot", "Graphviz .dot"),
+                                              clEnumValN(GraphFormat::Json, "json", "JSON with nodes and edges"),
+                                              clEnumValN(GraphFormat::EdgeList, "edges", "Edge list")));
+
 namespace {
   struct OurCallGraphPass : public ModulePass {
     static char ID;
@@ -16,6 +23,7 @@ namespace {
       OurCallGraph* CallGraph = new OurCallGraph();
 
       CallGraph->CreateCallGraph(M);
+      CallGraph->SetExportOptions({Format, false});
       CallGraph->dumpGraphToFile();
 
       return false;
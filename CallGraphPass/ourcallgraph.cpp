@@ -1,8 +1,11 @@
 #include "ourcallgraph.h"
 
+#include <algorithm>
+
 void OurCallGraph::CreateCallGraph(Module &M)
 {
     ModuleName = M.getName().str();
+    Mod = &M;
     Function* Main = M.getFunction("main");
 
     if (Main == nullptr) {
@@ -13,59 +16,84 @@ void OurCallGraph::CreateCallGraph(Module &M)
     DFS(Main);
 }
 
+void OurCallGraph::SetExportOptions(const GraphExportOptions &NewOptions)
+{
+    Options = NewOptions;
+}
+
 void OurCallGraph::DFS(Function* F)
 {
-    // Krecemo se prvo kroz svaki basic block u okviru funkcije, a zatim za svaku instrukciju proveravamo
-    // da li je u pitanju CALL instrukcija. Ako jeste, to znaci da dolazi do poziva neke druge funkcije,
-    // pa je samim tim neophodno da upamtimo to u listi povezanosti i nastavimo pretragu dalje u dubinu.
-
-    for (auto &BB : *F) {
-        for (auto &Instr : BB) {
-            
-            // Koristiti llvm-ov dyn_cast, a ne iz stl-a
-            if (auto CallInstruction = dyn_cast<CallInst>(&Instr)) {
-                // Dohvatamo funkciju koja se poziva
-                // getCalledFunction vraca nullptr ako ne postoji poziv nijedne funkcije
-
-                Function* Callee = CallInstruction->getCalledFunction();
-                AdjacencyList[F].insert(Callee);
-
-                // Ako pozvana funkcija ne postoji vec u listi povezanosti, znaci da treba nju dalje
-                // da obradjujemo. Inicijalizujemo funkcije koje ona poziva na prazan skup, a zatim
-                // nastavljamo DFS.
-
-                if (AdjacencyList.find(Callee) == AdjacencyList.end()) {
-                    AdjacencyList[Callee] = {};
-                    DFS(Callee);
+    // Funkcija je posecena cim postoji u listi povezanosti. Naslednici se racunaju kada se u
+    // funkciju prvi put udje: krecemo se kroz svaki basic block u okviru funkcije, a zatim za svaku
+    // instrukciju proveravamo da li je u pitanju CALL instrukcija. Ako jeste, to znaci da dolazi do
+    // poziva neke druge funkcije, pa je samim tim neophodno da upamtimo to u listi povezanosti.
+    // Obilazak je iterativan (zajednicki DFS), pa duboki lanci poziva ne prepunjuju stek.
+
+    DepthFirstSearch(
+        F,
+        [this](Function* Caller) -> std::unordered_set<Function*>& {
+            std::unordered_set<Function*> &Callees = AdjacencyList[Caller];
+
+            for (auto &BB : *Caller) {
+                for (auto &Instr : BB) {
+
+                    // Koristiti llvm-ov dyn_cast, a ne iz stl-a
+                    if (auto CallInstruction = dyn_cast<CallInst>(&Instr)) {
+                        // Dohvatamo funkciju koja se poziva
+                        // getCalledFunction vraca nullptr kod indirektnog poziva, koji ne ulazi u graf
+
+                        Function* Callee = CallInstruction->getCalledFunction();
+                        if (Callee != nullptr)
+                            Callees.insert(Callee);
+                    }
                 }
             }
-        }
-    }
+
+            return Callees;
+        },
+        [this](Function* Callee, Function*) {
+            return AdjacencyList.find(Callee) == AdjacencyList.end();
+        },
+        [](Function*) {});
 }
 
 void OurCallGraph::dumpGraphToFile()
 {
-    std::ofstream File;
-    File.open(ModuleName + ".dot");
+    GraphExporter Exporter(Options, "Call graph: " + ModuleName, {"#12535c", "#21828f"});
+    std::string Error;
 
-    File << "digraph \"Call graph: " << ModuleName << "\" {\n";
-    File << "\tlabel=\"Call graph: " << ModuleName << "\";\n";
+    if (!Exporter.Open(ModuleName + GetGraphFileExtension(Options.Format), Error)) {
+        errs() << Error << "\n";
+        return;
+    }
 
-    // Svaki cvor zapisan je u narednom formatu:
-    // Node0x559967de8350 [shape=record, label="{print_hello_world}"];
+    // Cvorovi su funkcije iz liste povezanosti, numerisane redom kojim su u modulu, a ne redom iz
+    // hes tabele, pa je fajl isti pri svakom pokretanju. Iz istog razloga se i grane sortiraju.
+    std::unordered_map<Function*, unsigned> NodeId;
+    std::vector<Function*> Nodes;
+    for (Function &F : *Mod) {
+        if (AdjacencyList.find(&F) != AdjacencyList.end()) {
+            NodeId[&F] = Nodes.size();
+            Nodes.push_back(&F);
+        }
+    }
 
-    // Prolazimo kroz elemente liste povezanosti
-    for (auto &kvp : AdjacencyList) {
-        File << "\tNode" << kvp.first << " [shape=record, color=\"#12535c\", style=filled, fillcolor=\"#21828f\", label=\"{" <<
-                kvp.first->getName().str() << "}\"];\n";
+    std::vector<unsigned> Callees;
+    for (Function* Caller : Nodes) {
+        unsigned Id = NodeId[Caller];
+        Exporter.AddNode(Id, Caller->getName().str());
 
         // Kada postoji grana izmedju dva cvora u grafu, reprezentuje se na sledeci nacin:
-        // Node0x559967de8350 -> Node0x559967de8351, gde su heksadekadne cifre adrese tih cvorova u memoriji
+        // Node0 -> Node1, gde su brojevi redni brojevi tih funkcija
+        Callees.clear();
+        for (Function* Callee : AdjacencyList[Caller])
+            Callees.push_back(NodeId[Callee]);
+        std::sort(Callees.begin(), Callees.end());
 
-        for (auto F : kvp.second)
-            File << "\tNode" << kvp.first << " -> " << "Node" << F << ";\n";
+        for (unsigned Callee : Callees)
+            Exporter.AddEdge(Id, Callee);
     }
 
-    File << "}";
-    File.close();
+    if (!Exporter.Close(Error))
+        errs() << Error << "\n";
 }
@@ -3,10 +3,11 @@
 
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Instructions.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "../Graph/GraphExporter.h"
 
 #include <unordered_map>
 #include <unordered_set>
-#include <fstream>
 
 using namespace llvm;
 
@@ -15,8 +16,11 @@ class OurCallGraph
 private:
     std::unordered_map<Function* , std::unordered_set<Function*>> AdjacencyList;
     std::string ModuleName;
+    Module* Mod = nullptr;
+    GraphExportOptions Options;
 public:
     void CreateCallGraph(Module &M);
+    void SetExportOptions(const GraphExportOptions&);
     void DFS(Function* F);
     void dumpGraphToFile();
 };
@@ -9,37 +9,48 @@ CFG::CFG(Function &F)
   CreateCFG(F);
 }
 
-void CFG::AddEdge(BasicBlock *From, BasicBlock *To)
+void CFG::CreateCFG(Function &F)
 {
-  AdjacencyList[From].push_back(To);
+  Graph = DenseCFG::Get(F);
+
+  Order.Reset(Graph->GetNumOfBlocks());
+  BackEdgeSources.assign(Graph->GetNumOfBlocks(), false);
 }
 
-void CFG::CreateCFG(Function &F)
+// Graf se uzima iz kesa, pa se posle izmena funkcije pravi iznova samo ako su se grane promenile
+void CFG::Recompute(Function &F)
 {
-  StartBlock = &F.front();
-
-  for (BasicBlock &BB : F) {
-    AdjacencyList[&BB] = {};
-    for (BasicBlock *Successor : successors(&BB))
-      AddEdge(&BB, Successor);
-  }
+  CreateCFG(F);
+  TraverseGraph();
 }
 
 void CFG::TraverseGraph()
 {
-  DFS(StartBlock);
+  if (Graph->GetNumOfBlocks() != 0)
+    DFS(0);
 }
 
-void CFG::DFS(BasicBlock *Current)
+// Grana ka pretku u DFS stablu (bloku koji je bio na DFS steku) je povratna
+void CFG::DFS(unsigned Start)
 {
-  Visited.insert(Current);
+  Order.Run(Start, [this](unsigned Current) { return Graph->GetSuccessors(Current); });
 
-  for (BasicBlock *Successor : AdjacencyList[Current])
-    if (Visited.find(Successor) == Visited.end())
-      DFS(Successor);
+  for (unsigned Current : Order.Preorder) {
+    for (unsigned Successor : Graph->GetSuccessors(Current))
+      if (Order.IsBackEdge(Current, Successor))
+        BackEdgeSources[Current] = true;
+  }
 }
 
+// Blok koji nije u grafu (dodat posle pravljenja) se smatra nedostiznim
 bool CFG::IsReachable(BasicBlock *BB)
 {
-  return Visited.find(BB) != Visited.end();
-}
\ No newline at end of file
+  int Index = Graph->GetIndex(BB);
+  return Index != -1 && Order.IsVisited(Index);
+}
+
+bool CFG::HasBackEdge(BasicBlock *BB)
+{
+  int Index = Graph->GetIndex(BB);
+  return Index != -1 && BackEdgeSources[Index];
+}
@@ -7,26 +7,31 @@
 
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Instructions.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/DepthFirstSearch.h"
 
-#include <unordered_map>
-#include <unordered_set>
+#include <memory>
 #include <vector>
 
 using namespace llvm;
 
+// Dostiznost i povratne grane nad zajednickim DenseCFG-om: rezultati obilaska su nizovi
+// indeksirani gustim indeksom bloka
 class CFG {
 private:
-  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> AdjacencyList;
-  std::unordered_set<BasicBlock *> Visited;
-  BasicBlock *StartBlock;
+  std::shared_ptr<const DenseCFG> Graph;
+  DFSOrder<unsigned> Order;
+  // BasicBlock-ovi iz kojih polazi povratna grana
+  std::vector<bool> BackEdgeSources;
 
   void CreateCFG(Function &F);
-  void DFS(BasicBlock *Current);
-  void AddEdge(BasicBlock *, BasicBlock *);
+  void DFS(unsigned Start);
 public:
   CFG(Function &F);
+  void Recompute(Function &F);
   void TraverseGraph();
   bool IsReachable(BasicBlock *);
+  bool HasBackEdge(BasicBlock *);
 };
 
 #endif // LLVM_PROJECT_CFG_H
@@ -1,3 +1,4 @@
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Pass.h"
@@ -5,13 +6,23 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/Support/CommandLine.h"
 #include "CFG.h"
+#include "PurityAnalysis.h"
+#include "DeadLoopElimination.h"
+#include "../DominatorTreePass/DominatorTree.h"
 
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 using namespace llvm;
 
+static cl::opt<bool> AggressiveDCE("aggressive-dce", cl::init(false),
+                                   cl::desc("Single-pass mark-and-sweep dead code elimination"));
+static cl::opt<bool> RemoveDeadLoops("dce-remove-loops", cl::init(false),
+                                     cl::desc("Delete provably terminating loops without observable effects"));
+
 namespace {
 
 struct DeadCodeEliminationPass : public FunctionPass {
@@ -19,6 +30,14 @@ struct DeadCodeEliminationPass : public FunctionPass {
   DeadCodeEliminationPass() : FunctionPass(ID) {};
 
   bool EliminateInstruction;
+  PurityAnalysis Purity;
+  // Isti graf se koristi u svim koracima nad jednom funkcijom i samo se ponovo racuna
+  CFG *Graph = nullptr;
+
+  bool doInitialization(Module &) override {
+    Purity.Clear();
+    return false;
+  }
 
   void EliminateUnusedVariables(Function &F)
   {
@@ -37,9 +56,12 @@ struct DeadCodeEliminationPass : public FunctionPass {
     for (BasicBlock &BB : F) {
       for (Instruction &Instr : BB) {
         if (Instr.getType() != Type::getVoidTy(Instr.getContext())) {
-          // ako instrukcija nije call, onda postavljamo da promenljiva nije koriscena
-          if (!isa<CallInst>(&Instr))
+          // ako instrukcija nije call, ili je poziv ciste funkcije, onda postavljamo da promenljiva nije koriscena
+          if (!isa<CallInst>(&Instr) || Purity.IsRemovableCall(&Instr))
             Variables[&Instr] = false;
+        } else if (Purity.IsRemovableCall(&Instr)) {
+          // poziv ciste funkcije bez povratne vrednosti nema nikakav efekat
+          InstructionsToRemove.insert(&Instr);
         }
 
         if (isa<LoadInst>(&Instr))
@@ -68,7 +90,8 @@ struct DeadCodeEliminationPass : public FunctionPass {
     for (BasicBlock &BB : F) {
       for (Instruction &Instr : BB) {
         if (isa<StoreInst>(&Instr)) {
-          if (!Variables[Instr.getOperand(1)])
+          // upis u globalnu promenljivu ili kroz argument je vidljiv van funkcije
+          if (Variables.find(Instr.getOperand(1)) != Variables.end() && !Variables[Instr.getOperand(1)])
             InstructionsToRemove.insert(&Instr);
         } else if (Variables.find(&Instr) != Variables.end() && !Variables[&Instr]) {
           InstructionsToRemove.insert(&Instr);
@@ -87,18 +110,39 @@ struct DeadCodeEliminationPass : public FunctionPass {
       Instr->eraseFromParent();
   }
 
+  // Nedostizne blokove brisemo u jednom prolazu: prvo se iz phi cvorova zivih successora uklanjaju
+  // ulazi iz mrtvih blokova, zatim se raskidaju sve veze mrtvih instrukcija, pa tek onda brisu
+  // blokovi, tako da ni u jednom trenutku ne ostaje upotreba obrisane vrednosti.
   void EliminateUnreachableInstructions(Function &F)
   {
-    CFG *Graph = new CFG(F);
-    Graph->TraverseGraph();
+    Graph->Recompute(F);
 
     std::vector<BasicBlock *> BasicBlocksToRemove = {};
     for (BasicBlock &BB : F)
       if (!Graph->IsReachable(&BB))
         BasicBlocksToRemove.push_back(&BB);
 
-    if (!BasicBlocksToRemove.empty())
-      EliminateInstruction = true;
+    if (BasicBlocksToRemove.empty())
+      return;
+
+    EliminateInstruction = true;
+
+    for (BasicBlock *BB : BasicBlocksToRemove) {
+      for (BasicBlock *Successor : successors(BB))
+        if (Graph->IsReachable(Successor))
+          Successor->removePredecessor(BB);
+    }
+
+    for (BasicBlock *BB : BasicBlocksToRemove)
+      BB->dropAllReferences();
+
+    // Posle raskidanja veza mrtve vrednosti mogu koristiti jos samo mrtve instrukcije, ali za svaki
+    // slucaj ih zamenjujemo sa undef pre brisanja
+    for (BasicBlock *BB : BasicBlocksToRemove) {
+      for (Instruction &Instr : *BB)
+        if (!Instr.use_empty())
+          Instr.replaceAllUsesWith(UndefValue::get(Instr.getType()));
+    }
 
     for (BasicBlock *BB : BasicBlocksToRemove)
       BB->eraseFromParent();
@@ -108,14 +152,355 @@ struct DeadCodeEliminationPass : public FunctionPass {
   {
     EliminateInstruction = false;
     EliminateUnusedVariables(F);
+    EliminateDeadStores(F);
+    if (RemoveDeadLoops && DeadLoopElimination(Purity).Run(F))
+      EliminateInstruction = true;
+    EliminateUnreachableInstructions(F);
+  }
+
+  std::unordered_set<Instruction *> Live = {};
+  std::unordered_set<BasicBlock *> LiveBlocks = {};
+  std::vector<Instruction *> Worklist = {};
+  // BasicBlock -> BasicBlock-ovi cija grananja odlucuju da li ce se on izvrsiti
+  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> ControlDependences = {};
+
+  bool IsUnconditionalBranch(Instruction *Instr)
+  {
+    auto *Branch = dyn_cast<BranchInst>(Instr);
+    return Branch != nullptr && Branch->isUnconditional();
+  }
+
+  // Blok B je kontrolno zavisan od A ako A ima granu ka S, a B lezi na putanji od S do
+  // neposrednog postdominatora bloka A u stablu postdominatora.
+  void FindControlDependences(Function &F, DominatorTree *PostDomTree)
+  {
+    for (BasicBlock &BB : F) {
+      if (BB.getTerminator() == nullptr || BB.getTerminator()->getNumSuccessors() < 2)
+        continue;
+
+      BasicBlock *PostDominator = PostDomTree->GetImmediateDominator(&BB);
+      std::unordered_set<BasicBlock *> UniqueSuccessors(succ_begin(&BB), succ_end(&BB));
+
+      for (BasicBlock *Successor : UniqueSuccessors) {
+        BasicBlock *Runner = Successor;
+        while (Runner != nullptr && Runner != PostDominator && PostDomTree->Contains(Runner)) {
+          ControlDependences[Runner].push_back(&BB);
+          Runner = PostDomTree->GetImmediateDominator(Runner);
+        }
+      }
+    }
+  }
+
+  // Upis u lokalnu promenljivu je mrtav ako na svakoj putanji od njega do izlaza iz funkcije
+  // sledi novi upis pre nekog citanja. Zivost promenljivih racunamo unazad, sa po jednim bitom
+  // za svaku alloca-u koja ne bezi:
+  //   LiveOut(B) = unija LiveIn(S) za sve successore S
+  //   LiveIn(B) = Gen(B) | (LiveOut(B) & ~Kill(B))
+  // gde je Gen skup promenljivih koje se citaju pre prvog upisa u bloku, a Kill skup promenljivih
+  // u koje se upisuje.
+  void EliminateDeadStores(Function &F)
+  {
+    std::unordered_map<AllocaInst *, unsigned> VariableIndex = {};
+    for (Instruction &Instr : F.getEntryBlock()) {
+      if (auto *Alloca = dyn_cast<AllocaInst>(&Instr))
+        if (!PurityAnalysis::IsEscapingAlloca(Alloca))
+          VariableIndex[Alloca] = VariableIndex.size();
+    }
+
+    if (VariableIndex.empty())
+      return;
+
+    unsigned NumOfVariables = VariableIndex.size();
+    std::unordered_map<BasicBlock *, BitVector> Gen = {};
+    std::unordered_map<BasicBlock *, BitVector> Kill = {};
+    std::unordered_map<BasicBlock *, BitVector> LiveIn = {};
+    std::unordered_map<BasicBlock *, BitVector> LiveOut = {};
+
+    auto GetVariable = [&](Value *Pointer) -> int {
+      auto *Alloca = dyn_cast<AllocaInst>(Pointer);
+      auto It = Alloca ? VariableIndex.find(Alloca) : VariableIndex.end();
+      return It == VariableIndex.end() ? -1 : (int)It->second;
+    };
+
+    for (BasicBlock &BB : F) {
+      Gen[&BB] = BitVector(NumOfVariables);
+      Kill[&BB] = BitVector(NumOfVariables);
+      LiveIn[&BB] = BitVector(NumOfVariables);
+      LiveOut[&BB] = BitVector(NumOfVariables);
+
+      for (Instruction &Instr : BB) {
+        if (auto *Load = dyn_cast<LoadInst>(&Instr)) {
+          int Variable = GetVariable(Load->getPointerOperand());
+          if (Variable != -1 && !Kill[&BB].test(Variable))
+            Gen[&BB].set(Variable);
+        } else if (auto *Store = dyn_cast<StoreInst>(&Instr)) {
+          int Variable = GetVariable(Store->getPointerOperand());
+          if (Variable != -1)
+            Kill[&BB].set(Variable);
+        }
+      }
+    }
+
+    // Obrnuti redosled blokova u funkciji obicno je blizu obrnutog topoloskog, pa se brzo stabilizuje
+    std::vector<BasicBlock *> Worklist = {};
+    std::unordered_set<BasicBlock *> InWorklist = {};
+    for (BasicBlock &BB : F) {
+      Worklist.push_back(&BB);
+      InWorklist.insert(&BB);
+    }
+
+    while (!Worklist.empty()) {
+      BasicBlock *BB = Worklist.back();
+      Worklist.pop_back();
+      InWorklist.erase(BB);
+
+      BitVector &Out = LiveOut[BB];
+      for (BasicBlock *Successor : successors(BB))
+        Out |= LiveIn[Successor];
+
+      BitVector In = Out;
+      In.reset(Kill[BB]);
+      In |= Gen[BB];
+
+      if (In == LiveIn[BB])
+        continue;
+
+      LiveIn[BB] = In;
+      for (BasicBlock *Predecessor : predecessors(BB))
+        if (InWorklist.insert(Predecessor).second)
+          Worklist.push_back(Predecessor);
+    }
+
+    std::vector<Instruction *> InstructionsToRemove = {};
+    for (BasicBlock &BB : F) {
+      BitVector Live = LiveOut[&BB];
+
+      for (auto It = BB.rbegin(); It != BB.rend(); ++It) {
+        if (auto *Load = dyn_cast<LoadInst>(&*It)) {
+          int Variable = GetVariable(Load->getPointerOperand());
+          if (Variable != -1)
+            Live.set(Variable);
+        } else if (auto *Store = dyn_cast<StoreInst>(&*It)) {
+          int Variable = GetVariable(Store->getPointerOperand());
+          if (Variable == -1)
+            continue;
+
+          if (!Live.test(Variable) && !Store->isVolatile())
+            InstructionsToRemove.push_back(Store);
+          Live.reset(Variable);
+        }
+      }
+    }
+
+    errs() << "======= DEAD STORES =======\n";
+    for (Instruction *Instr : InstructionsToRemove) {
+      Instr->print(errs(), false);
+      errs() << "\n";
+    }
+    errs() << "\n";
+
+    if (!InstructionsToRemove.empty())
+      EliminateInstruction = true;
+
+    for (Instruction *Instr : InstructionsToRemove)
+      Instr->eraseFromParent();
+  }
+
+  // Korenske instrukcije su one koje su zive bez obzira na to da li se njihov rezultat koristi:
+  // pozivi funkcija koje nisu ciste, sve sto ima sporedne efekte (osim upisa u lokalne promenljive
+  // koje ne beze) i terminatori koji nisu obicna grananja. Grananje je koren samo ako blok ne vodi
+  // do izlaza iz funkcije, ima successora koji ne vodi do izlaza ili zatvara petlju, kako ne bismo
+  // uklonili petlju za koju ne znamo da li se zavrsava. Blokovi koji ne vode do izlaza nisu u stablu
+  // postdominatora, pa za njih nema kontrolnih zavisnosti; zato grananje koje vodi u takav blok
+  // mora samo da bude koren.
+  bool IsRootInstruction(Instruction *Instr, const std::unordered_set<AllocaInst *> &LocalVariables,
+                         DominatorTree *PostDomTree)
+  {
+    if (auto *Store = dyn_cast<StoreInst>(Instr)) {
+      auto *Alloca = dyn_cast<AllocaInst>(Store->getPointerOperand());
+      return Store->isVolatile() || Alloca == nullptr || LocalVariables.find(Alloca) == LocalVariables.end();
+    }
+
+    if (isa<BranchInst>(Instr) || isa<SwitchInst>(Instr)) {
+      BasicBlock *BB = Instr->getParent();
+      if (!PostDomTree->Contains(BB) || Graph->HasBackEdge(BB))
+        return true;
+
+      for (BasicBlock *Successor : successors(BB))
+        if (!PostDomTree->Contains(Successor))
+          return true;
+      return false;
+    }
+
+    if (isa<CallBase>(Instr))
+      return !Purity.IsRemovableCall(Instr);
+
+    return Instr->isTerminator() || Instr->mayHaveSideEffects();
+  }
+
+  void MarkBlockLive(BasicBlock *BB)
+  {
+    if (!LiveBlocks.insert(BB).second)
+      return;
+
+    for (BasicBlock *Controller : ControlDependences[BB])
+      MarkLive(Controller->getTerminator());
+  }
+
+  // Bezuslovna grananja se nikad ne brisu, pa ih ne vodimo kao zive, vec samo njihov blok
+  void MarkLive(Instruction *Instr)
+  {
+    if (IsUnconditionalBranch(Instr)) {
+      MarkBlockLive(Instr->getParent());
+      return;
+    }
+
+    if (Live.insert(Instr).second)
+      Worklist.push_back(Instr);
+  }
+
+  // Mark-and-sweep varijanta: jedan prolaz oznacava zive instrukcije unazad kroz operande i
+  // kontrolne zavisnosti, a zatim se sve neoznacene instrukcije brisu odjednom, bez ponavljanja
+  // do fiksne tacke. Mrtvo grananje se zamenjuje skokom na neposredni postdominator, cime ceo
+  // uslovni region postaje nedostizan.
+  bool RunAggressiveAlgorithm(Function &F)
+  {
+    // lokalna promenljiva -> svi upisi u nju
+    std::unordered_map<AllocaInst *, std::vector<Instruction *>> StoresToVariable = {};
+    std::unordered_set<AllocaInst *> LocalVariables = {};
+
+    Live.clear();
+    LiveBlocks.clear();
+    Worklist.clear();
+    ControlDependences.clear();
+
+    // Upisi koje uvek prepisuje novi upis nisu zivi ni kada se promenljiva negde cita
+    EliminateDeadStores(F);
+
+    DominatorTree *PostDomTree = new DominatorTree(F, true);
+    PostDomTree->FindImmediateDominators();
+    FindControlDependences(F, PostDomTree);
+
+    Graph->Recompute(F);
+
+    for (BasicBlock &BB : F) {
+      for (Instruction &Instr : BB) {
+        if (auto *Alloca = dyn_cast<AllocaInst>(&Instr))
+          if (!PurityAnalysis::IsEscapingAlloca(Alloca))
+            LocalVariables.insert(Alloca);
+      }
+    }
+
+    for (BasicBlock &BB : F) {
+      for (Instruction &Instr : BB) {
+        if (auto *Store = dyn_cast<StoreInst>(&Instr))
+          if (auto *Alloca = dyn_cast<AllocaInst>(Store->getPointerOperand()))
+            StoresToVariable[Alloca].push_back(Store);
+
+        if (IsRootInstruction(&Instr, LocalVariables, PostDomTree))
+          MarkLive(&Instr);
+      }
+    }
+
+    while (!Worklist.empty()) {
+      Instruction *Current = Worklist.back();
+      Worklist.pop_back();
+
+      MarkBlockLive(Current->getParent());
+
+      for (Value *Operand : Current->operands()) {
+        if (auto *OperandInstr = dyn_cast<Instruction>(Operand))
+          MarkLive(OperandInstr);
+      }
+
+      // Vrednost phi cvora zavisi i od toga kojom granom se doslo u blok
+      if (auto *Phi = dyn_cast<PHINode>(Current)) {
+        for (BasicBlock *Incoming : Phi->blocks())
+          MarkLive(Incoming->getTerminator());
+      }
+
+      // Ako je citanje iz lokalne promenljive zivo, zivi su i svi upisi u nju
+      if (auto *Load = dyn_cast<LoadInst>(Current)) {
+        if (auto *Alloca = dyn_cast<AllocaInst>(Load->getPointerOperand())) {
+          for (Instruction *Store : StoresToVariable[Alloca])
+            MarkLive(Store);
+        }
+      }
+    }
+
+    std::vector<Instruction *> InstructionsToRemove = {};
+    std::vector<Instruction *> BranchesToRedirect = {};
+    for (BasicBlock &BB : F) {
+      for (Instruction &Instr : BB) {
+        if (Live.find(&Instr) != Live.end() || IsUnconditionalBranch(&Instr))
+          continue;
+
+        if (Instr.isTerminator()) {
+          if (PostDomTree->GetImmediateDominator(&BB) != nullptr)
+            BranchesToRedirect.push_back(&Instr);
+        } else {
+          InstructionsToRemove.push_back(&Instr);
+        }
+      }
+    }
+
+    errs() << "======= INSTRUCTIONS TO BE REMOVED =======\n";
+    for (Instruction *Instr : InstructionsToRemove)
+      errs() << Instr->getOpcodeName() << " " << Instr->getNumOperands() << "\n";
+    errs() << "\n";
+
+    // Mrtve instrukcije mogu koristiti jedna drugu, pa prvo raskidamo sve veze, a tek onda brisemo
+    for (Instruction *Instr : InstructionsToRemove)
+      Instr->dropAllReferences();
+    for (Instruction *Branch : BranchesToRedirect)
+      Branch->dropAllReferences();
+
+    for (Instruction *Instr : InstructionsToRemove)
+      Instr->eraseFromParent();
+
+    // Nijedan zivi phi cvor ne moze imati ulaz iz bloka cije je grananje mrtvo
+    for (Instruction *Branch : BranchesToRedirect) {
+      BasicBlock *BB = Branch->getParent();
+      BranchInst::Create(PostDomTree->GetImmediateDominator(BB), BB);
+      Branch->eraseFromParent();
+    }
+
+    delete PostDomTree;
+
+    EliminateInstruction = !InstructionsToRemove.empty() || !BranchesToRedirect.empty();
     EliminateUnreachableInstructions(F);
+
+    return EliminateInstruction;
   }
 
   bool runOnFunction(Function &F) override {
-    do {
-      RunAlgorithm(F);
-    } while (EliminateInstruction);
-    return true;
+    bool Changed = true;
+    Graph = new CFG(F);
+
+    if (AggressiveDCE) {
+      Changed = RunAggressiveAlgorithm(F);
+
+      // Petlje se ne uklanjaju tokom oznacavanja, pa posle brisanja mrtvih petlji ponavljamo
+      // prolaz jos jednom da bismo uklonili i ono sto su samo one koristile
+      if (RemoveDeadLoops && DeadLoopElimination(Purity).Run(F)) {
+        EliminateUnreachableInstructions(F);
+        RunAggressiveAlgorithm(F);
+        Changed = true;
+      }
+    } else {
+      do {
+        RunAlgorithm(F);
+      } while (EliminateInstruction);
+    }
+
+    delete Graph;
+    Graph = nullptr;
+    return Changed;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
   }
 };
 
@@ -0,0 +1,235 @@
+#include "DeadLoopElimination.h"
+
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Module.h"
+
+#include <vector>
+
+// Isti oblik petlje koji prepoznaje FindLoopBoundAndCounter u LoopUnrolling/LoopInversion:
+//   header:  %4 = load i32, ptr %counter
+//            %5 = icmp slt i32 %4, 10
+//            br i1 %5, label %body, label %exit
+//   latch:   %8 = load i32, ptr %counter
+//            %9 = add nsw i32 %8, 1
+//            store i32 %9, ptr %counter
+// Brojac se menja tacno jednom po iteraciji za konstantan korak (veci od 1 samo uz nsw/nuw), u
+// smeru granice, pa se petlja zavrsava posle konacnog broja koraka.
+static bool HasConstantTripCount(Loop *L, DominatorTree &DT)
+{
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+  auto *Branch = dyn_cast<BranchInst>(Header->getTerminator());
+
+  if (Latch == nullptr || Branch == nullptr || Branch->isUnconditional())
+    return false;
+
+  auto *Compare = dyn_cast<ICmpInst>(Branch->getCondition());
+  if (Compare == nullptr || L->contains(Branch->getSuccessor(0)) == L->contains(Branch->getSuccessor(1)))
+    return false;
+
+  auto *CounterLoad = dyn_cast<LoadInst>(Compare->getOperand(0));
+  auto *Counter = CounterLoad ? dyn_cast<AllocaInst>(CounterLoad->getPointerOperand()) : nullptr;
+  if (Counter == nullptr || PurityAnalysis::IsEscapingAlloca(Counter))
+    return false;
+
+  // Granica je konstanta ili lokalna promenljiva u koju se u petlji ne upisuje
+  Value *Bound = Compare->getOperand(1);
+  AllocaInst *BoundVariable = nullptr;
+  if (!isa<ConstantInt>(Bound)) {
+    auto *BoundLoad = dyn_cast<LoadInst>(Bound);
+    BoundVariable = BoundLoad ? dyn_cast<AllocaInst>(BoundLoad->getPointerOperand()) : nullptr;
+    if (BoundVariable == nullptr || BoundVariable == Counter || PurityAnalysis::IsEscapingAlloca(BoundVariable))
+      return false;
+  }
+
+  int64_t Step = 0;
+  BinaryOperator *Increment = nullptr;
+  unsigned NumOfStores = 0;
+  for (BasicBlock *BB : L->blocks()) {
+    for (Instruction &Instr : *BB) {
+      auto *Store = dyn_cast<StoreInst>(&Instr);
+      if (Store == nullptr)
+        continue;
+
+      if (Store->getPointerOperand() == BoundVariable)
+        return false;
+      if (Store->getPointerOperand() != Counter)
+        continue;
+
+      NumOfStores++;
+      if (!DT.dominates(Store->getParent(), Latch))
+        return false;
+
+      auto *Update = dyn_cast<BinaryOperator>(Store->getValueOperand());
+      auto *Previous = Update ? dyn_cast<LoadInst>(Update->getOperand(0)) : nullptr;
+      auto *Constant = Update ? dyn_cast<ConstantInt>(Update->getOperand(1)) : nullptr;
+      if (Previous == nullptr || Previous->getPointerOperand() != Counter || Constant == nullptr)
+        return false;
+
+      Increment = Update;
+      if (Update->getOpcode() == Instruction::Add)
+        Step = Constant->getSExtValue();
+      else if (Update->getOpcode() == Instruction::Sub)
+        Step = -Constant->getSExtValue();
+      else
+        return false;
+    }
+  }
+
+  if (NumOfStores != 1 || Step == 0)
+    return false;
+
+  // Predikat svodimo na oblik "true = ostajemo u petlji"
+  CmpInst::Predicate Predicate = Compare->getPredicate();
+  if (!L->contains(Branch->getSuccessor(0)))
+    Predicate = Compare->getInversePredicate();
+
+  // Korak veci od 1 moze da preskoci granicu i da se brojac prelije i vrti u krug (npr. i <u 0xFFFFFFFF
+  // sa i += 2), pa tada uvecanje mora imati nsw, odnosno nuw, prema znaku poredjenja
+  if (Step != 1 && Step != -1) {
+    bool NoWrap = CmpInst::isSigned(Predicate) ? Increment->hasNoSignedWrap() : Increment->hasNoUnsignedWrap();
+    if (!NoWrap)
+      return false;
+  }
+
+  // Za <= i >= granica ne sme biti ekstremna vrednost tipa, inace uslov nikad nije netacan
+  auto *ConstantBound = dyn_cast<ConstantInt>(Bound);
+  switch (Predicate) {
+  case CmpInst::ICMP_SLT:
+  case CmpInst::ICMP_ULT:
+    return Step > 0;
+  case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_UGT:
+    return Step < 0;
+  case CmpInst::ICMP_SLE:
+    return Step > 0 && ConstantBound && !ConstantBound->isMaxValue(true);
+  case CmpInst::ICMP_ULE:
+    return Step > 0 && ConstantBound && !ConstantBound->isMaxValue(false);
+  case CmpInst::ICMP_SGE:
+    return Step < 0 && ConstantBound && !ConstantBound->isMinValue(true);
+  case CmpInst::ICMP_UGE:
+    return Step < 0 && ConstantBound && !ConstantBound->isMinValue(false);
+  default:
+    return false;
+  }
+}
+
+static bool ProvablyTerminates(Loop *L, DominatorTree &DT, ScalarEvolution &SE)
+{
+  if (!SE.hasLoopInvariantBackedgeTakenCount(L) && !HasConstantTripCount(L, DT))
+    return false;
+
+  for (Loop *SubLoop : L->getSubLoops())
+    if (!ProvablyTerminates(SubLoop, DT, SE))
+      return false;
+
+  return true;
+}
+
+bool DeadLoopElimination::IsLoopDead(Loop *L)
+{
+  BasicBlock *ExitBlock = L->getExitBlock();
+  if (L->getLoopPreheader() == nullptr || ExitBlock == nullptr)
+    return false;
+
+  for (BasicBlock *BB : L->blocks()) {
+    for (Instruction &Instr : *BB) {
+      for (User *U : Instr.users()) {
+        auto *UserInstr = dyn_cast<Instruction>(U);
+        if (UserInstr == nullptr || !L->contains(UserInstr->getParent()))
+          return false;
+      }
+
+      if (auto *Store = dyn_cast<StoreInst>(&Instr)) {
+        auto *Alloca = dyn_cast<AllocaInst>(Store->getPointerOperand());
+        if (Store->isVolatile() || Alloca == nullptr || PurityAnalysis::IsEscapingAlloca(Alloca))
+          return false;
+
+        // Promenljiva u koju petlja upisuje ne sme se citati van petlje
+        for (User *U : Alloca->users())
+          if (isa<LoadInst>(U) && !L->contains(cast<Instruction>(U)->getParent()))
+            return false;
+      } else if (isa<CallBase>(&Instr)) {
+        if (!PurityAnalysis::IsMetadataOnlyCall(&Instr) && !Purity.IsRemovableCall(&Instr))
+          return false;
+      } else if (Instr.mayHaveSideEffects()) {
+        return false;
+      }
+    }
+  }
+
+  // Posle uklanjanja petlje u izlazni blok se ulazi iz preheader-a, pa svi ulazi phi cvorova
+  // iz petlje moraju nositi istu vrednost
+  for (PHINode &Phi : ExitBlock->phis()) {
+    Value *Incoming = nullptr;
+    for (unsigned i = 0; i < Phi.getNumIncomingValues(); ++i) {
+      if (!L->contains(Phi.getIncomingBlock(i)))
+        continue;
+      if (Incoming != nullptr && Incoming != Phi.getIncomingValue(i))
+        return false;
+      Incoming = Phi.getIncomingValue(i);
+    }
+  }
+
+  return true;
+}
+
+// Blokovi petlje ostaju u funkciji kao nedostizni; brise ih EliminateUnreachableInstructions,
+// koji ujedno uklanja i njihove ulaze iz phi cvorova izlaznog bloka.
+void DeadLoopElimination::RemoveLoop(Loop *L)
+{
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *ExitBlock = L->getExitBlock();
+
+  for (PHINode &Phi : ExitBlock->phis()) {
+    for (unsigned i = 0; i < Phi.getNumIncomingValues(); ++i) {
+      if (L->contains(Phi.getIncomingBlock(i))) {
+        Phi.addIncoming(Phi.getIncomingValue(i), Preheader);
+        break;
+      }
+    }
+  }
+
+  Preheader->getTerminator()->replaceSuccessorWith(L->getHeader(), ExitBlock);
+}
+
+bool DeadLoopElimination::Run(Function &F)
+{
+  DominatorTree DT(F);
+  LoopInfo LI(DT);
+  TargetLibraryInfoImpl TLII(Triple(F.getParent()->getTargetTriple()));
+  TargetLibraryInfo TLI(TLII);
+  AssumptionCache AC(F);
+  ScalarEvolution SE(F, TLI, AC, DT, LI);
+
+  // Ako je spoljasnja petlja mrtva, brise se zajedno sa svim ugnjezdenim, pa njih ne gledamo posebno
+  std::vector<Loop *> Worklist(LI.begin(), LI.end());
+  std::vector<Loop *> DeadLoops = {};
+
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.back();
+    Worklist.pop_back();
+
+    if (IsLoopDead(L) && ProvablyTerminates(L, DT, SE)) {
+      DeadLoops.push_back(L);
+    } else {
+      for (Loop *SubLoop : L->getSubLoops())
+        Worklist.push_back(SubLoop);
+    }
+  }
+
+  errs() << "======= DEAD LOOPS =======\n";
+  for (Loop *L : DeadLoops) {
+    L->getHeader()->printAsOperand(errs(), false);
+    errs() << " (" << L->getNumBlocks() << " blocks)\n";
+    RemoveLoop(L);
+  }
+  errs() << "\n";
+
+  return !DeadLoops.empty();
+}
@@ -0,0 +1,31 @@
+#ifndef LLVM_PROJECT_DEADLOOPELIMINATION_H
+#define LLVM_PROJECT_DEADLOOPELIMINATION_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include "PurityAnalysis.h"
+
+namespace llvm {
+class Loop;
+}
+
+using namespace llvm;
+
+// Uklanja petlje koje nemaju vidljiv efekat: nijedna vrednost iz petlje se ne koristi posle nje,
+// upisuje se samo u lokalne promenljive koje se ne citaju van petlje, pozivaju se samo ciste
+// funkcije i za svaku (i ugnjezdenu) petlju moze se dokazati da se zavrsava. Preheader se tada
+// preusmerava direktno na izlazni blok, a telo petlje postaje nedostizno.
+class DeadLoopElimination {
+private:
+  PurityAnalysis &Purity;
+
+  bool IsLoopDead(Loop *L);
+  void RemoveLoop(Loop *L);
+public:
+  DeadLoopElimination(PurityAnalysis &Purity) : Purity(Purity) {}
+
+  bool Run(Function &F);
+};
+
+#endif // LLVM_PROJECT_DEADLOOPELIMINATION_H
@@ -0,0 +1,104 @@
+#include "PurityAnalysis.h"
+#include "CFG.h"
+#include "llvm/IR/IntrinsicInst.h"
+
+// Alloca "bezi" ako se koristi bilo gde osim kao adresa u load/store instrukciji
+// (npr. prosledjuje se funkciji, ulazi u GEP ili se sama upisuje u memoriju).
+bool PurityAnalysis::IsEscapingAlloca(AllocaInst *Alloca)
+{
+  for (User *U : Alloca->users()) {
+    if (auto *Load = dyn_cast<LoadInst>(U)) {
+      if (Load->getPointerOperand() == Alloca)
+        continue;
+    } else if (auto *Store = dyn_cast<StoreInst>(U)) {
+      if (Store->getPointerOperand() == Alloca && Store->getValueOperand() != Alloca)
+        continue;
+    }
+    return true;
+  }
+  return false;
+}
+
+// Intrinsici koji samo nose metapodatke (llvm.dbg.*, pseudo probe, noalias scope) nemaju sporedne
+// efekte, ali se ne brisu kao mrtvi, jer bi se time izgubile debug informacije
+bool PurityAnalysis::IsMetadataOnlyCall(Instruction *Instr)
+{
+  return Instr->isDebugOrPseudoInst() || isa<NoAliasScopeDeclInst>(Instr);
+}
+
+// Poziv se moze ukloniti samo ako je u pitanju obican call (ne invoke) poznate funkcije
+bool PurityAnalysis::IsRemovableCall(Instruction *Instr)
+{
+  auto *Call = dyn_cast<CallInst>(Instr);
+  if (Call == nullptr || IsMetadataOnlyCall(Call))
+    return false;
+
+  Function *Callee = Call->getCalledFunction();
+  if (Callee == nullptr)
+    return false;
+
+  if (!Call->mayHaveSideEffects())
+    return true;
+
+  return !Callee->isDeclaration() && IsPure(Callee);
+}
+
+bool PurityAnalysis::IsPure(Function *F)
+{
+  auto It = Cache.find(F);
+  // Rekurzivne funkcije (poziv funkcije koja je jos u obradi) smatramo necistim, jer ne znamo
+  // da li se zavrsavaju
+  if (It != Cache.end())
+    return It->second == State::Pure;
+
+  Cache[F] = State::InProgress;
+  bool Pure = AnalyzeFunction(F);
+  Cache[F] = Pure ? State::Pure : State::Impure;
+
+  return Pure;
+}
+
+bool PurityAnalysis::AnalyzeFunction(Function *F)
+{
+  if (F->isDeclaration() || F->isInterposable())
+    return false;
+
+  // Petlja moze biti beskonacna, osim ako frontend ne garantuje suprotno
+  if (!F->willReturn()) {
+    CFG *Graph = new CFG(*F);
+    Graph->TraverseGraph();
+
+    bool HasLoop = false;
+    for (BasicBlock &BB : *F)
+      HasLoop = HasLoop || Graph->HasBackEdge(&BB);
+
+    delete Graph;
+    if (HasLoop)
+      return false;
+  }
+
+  for (BasicBlock &BB : *F) {
+    for (Instruction &Instr : BB) {
+      if (auto *Store = dyn_cast<StoreInst>(&Instr)) {
+        auto *Alloca = dyn_cast<AllocaInst>(Store->getPointerOperand());
+        if (Store->isVolatile() || Alloca == nullptr || IsEscapingAlloca(Alloca))
+          return false;
+      } else if (auto *Load = dyn_cast<LoadInst>(&Instr)) {
+        if (Load->isVolatile())
+          return false;
+      } else if (isa<CallBase>(&Instr)) {
+        if (!IsMetadataOnlyCall(&Instr) && !IsRemovableCall(&Instr))
+          return false;
+      } else if (Instr.mayHaveSideEffects() || isa<ResumeInst>(&Instr) || isa<UnreachableInst>(&Instr)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void PurityAnalysis::Clear()
+{
+  Cache.clear();
+}
@@ -0,0 +1,30 @@
+#ifndef LLVM_PROJECT_PURITYANALYSIS_H
+#define LLVM_PROJECT_PURITYANALYSIS_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+
+#include <unordered_map>
+
+using namespace llvm;
+
+// Funkcija je cista ako se sigurno zavrsava, ne baca izuzetke i ne menja nista osim svojih
+// lokalnih promenljivih. Poziv ciste funkcije ciji se rezultat ne koristi moze se obrisati.
+// Za deklaracije se oslanjamo na atribute (readnone/readonly, willreturn, nounwind), a funkcije
+// definisane u modulu analiziramo same i rezultat pamtimo.
+class PurityAnalysis {
+private:
+  enum class State { InProgress, Pure, Impure };
+  std::unordered_map<Function *, State> Cache;
+
+  bool AnalyzeFunction(Function *F);
+public:
+  static bool IsEscapingAlloca(AllocaInst *Alloca);
+  static bool IsMetadataOnlyCall(Instruction *Instr);
+
+  bool IsPure(Function *F);
+  bool IsRemovableCall(Instruction *Instr);
+  void Clear();
+};
+
+#endif // LLVM_PROJECT_PURITYANALYSIS_H
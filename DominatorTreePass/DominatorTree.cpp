@@ -1,135 +1,1328 @@
 #include "DominatorTree.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
 
-DominatorTree::DominatorTree(Function &F)
+#include <algorithm>
+#include <map>
+#include <queue>
+
+// Blokovi i grane se uzimaju iz zajednickog DenseCFG-a. CSR graf za Semi-NCA se pravi odmah, a
+// liste povezanosti (za Lengauer-Tarjan i inkrementalne izmene) se pune iz istih grana.
+DominatorTree::DominatorTree(Function &F, bool PostDominators)
 {
   FunctionName = F.getName().str();
-  StartBlock = &F.front();
+  IsPostDominatorTree = PostDominators;
+  VirtualExit = nullptr;
+  BalancedLinking = false;
+  Engine = DominatorEngine::LengauerTarjan;
+  DFSNumbersValid = false;
+  LCAIndexValid = false;
+  DenseGraphStale = false;
   Time = 1;
 
-  for (BasicBlock &BB : F) {
-    AdjacencyList[&BB] = {};
-    for (BasicBlock* Successor : successors(&BB))
-      AddEdge(&BB, Successor);
+  Snapshot = DenseCFG::Get(F);
+  const DenseCFG &Graph = *Snapshot;
+  unsigned NumOfBlocks = Graph.GetNumOfBlocks();
+
+  if (!IsPostDominatorTree) {
+    StartBlock = Graph.GetBlock(0);
+    Blocks = Graph.GetBlocks();
+    DenseGraph = Graph.GetGraph();
+
+    for (BasicBlock* BB : Blocks)
+      AdjacencyList[BB] = {};
+
+    for (unsigned i = 0; i < NumOfBlocks; ++i) {
+      for (unsigned Successor : Graph.GetSuccessors(i))
+        AddEdge(Blocks[i], Blocks[Successor]);
+    }
+
+    return;
+  }
+
+  // Postdominatori se racunaju kao dominatori na obrnutom grafu, sa korenom u vestackom izlazu.
+  // Vestacki izlaz ima indeks 0, a blok sa indeksom i u DenseCFG-u ovde ima indeks i + 1.
+  VirtualExit = BasicBlock::Create(F.getContext(), "exit");
+  StartBlock = VirtualExit;
+  Blocks.push_back(VirtualExit);
+  AdjacencyList[VirtualExit] = {};
+
+  for (BasicBlock* BB : Graph.GetBlocks()) {
+    Blocks.push_back(BB);
+    AdjacencyList[BB] = {};
+  }
+
+  std::vector<std::pair<unsigned, unsigned>> Edges;
+  for (unsigned i = 0; i < NumOfBlocks; ++i) {
+    if (Graph.GetSuccessors(i).empty()) {
+      AddEdge(VirtualExit, Blocks[i + 1]);
+      Edges.push_back({0, i + 1});
+    }
+
+    for (unsigned Successor : Graph.GetSuccessors(i)) {
+      AddEdge(Blocks[Successor + 1], Blocks[i + 1]);
+      Edges.push_back({Successor + 1, i + 1});
+    }
   }
+
+  DenseGraph.Build(Blocks.size(), Edges);
+}
+
+// Prazno stablo, koristi ga samo Verify za ponovno racunanje nad istim grafom
+DominatorTree::DominatorTree()
+{
+  IsPostDominatorTree = false;
+  VirtualExit = nullptr;
+  StartBlock = nullptr;
+  BalancedLinking = false;
+  Engine = DominatorEngine::LengauerTarjan;
+  DFSNumbersValid = false;
+  LCAIndexValid = false;
+  DenseGraphStale = true;
+  Time = 1;
+}
+
+DominatorTree::~DominatorTree()
+{
+  delete VirtualExit;
+}
+
+// Blok koji nije bio u funkciji kad je stablo napravljeno (npr. blok kojim je grana podeljena)
+// dobija sledeci indeks u Blocks, da bi bio i u CSR grafu posle sledeceg BuildDenseGraph-a
+void DominatorTree::AddBlock(BasicBlock *BB)
+{
+  if (AdjacencyList.emplace(BB, std::vector<BasicBlock*>()).second)
+    Blocks.push_back(BB);
 }
 
 void DominatorTree::AddEdge(BasicBlock *From, BasicBlock *To)
 {
+  AddBlock(From);
+  AddBlock(To);
   AdjacencyList[From].push_back(To);
   ReversedAdjacencyList[To].push_back(From);
 }
 
-void DominatorTree::DFS(BasicBlock *BB, int &Time)
+void DominatorTree::SetBalancedLinking(bool Balanced)
+{
+  BalancedLinking = Balanced;
+}
+
+void DominatorTree::SetEngine(DominatorEngine NewEngine)
+{
+  Engine = NewEngine;
+}
+
+int DominatorTree::Number(BasicBlock *BB)
+{
+  auto It = InNumeration.find(BB);
+  return It == InNumeration.end() ? 0 : It->second;
+}
+
+void DominatorTree::DFS(BasicBlock *Start, int &Time)
+{
+  DepthFirstSearch(
+      Start,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return AdjacencyList[Current];
+      },
+      [this, Start, &Time](BasicBlock *Successor, BasicBlock *Current) {
+        if (!Visited.insert(Successor).second)
+          return false;
+
+        VisitedOrder.push_back(Successor);
+        InNumeration[Successor] = Time++;
+        if (Successor != Start)
+          Parents[Successor] = Current;
+        return true;
+      },
+      [](BasicBlock*) {});
+}
+
+// Sabijanje putanje u sumi: svaki cvor na putanji do korena stabla dobija za pretka koren, a za
+// labelu cvor sa najmanjim semidominatorom na putanji. Radi se iterativno, odozgo nadole.
+void DominatorTree::Compress(BasicBlock *BB)
+{
+  std::vector<BasicBlock*> Path;
+
+  while (Ancestors[Ancestors[BB]] != nullptr) {
+    Path.push_back(BB);
+    BB = Ancestors[BB];
+  }
+
+  for (auto It = Path.rbegin(); It != Path.rend(); ++It) {
+    BasicBlock* Current = *It;
+    BasicBlock* Ancestor = Ancestors[Current];
+
+    if (Number(SDom[Label[Ancestor]]) < Number(SDom[Label[Current]]))
+      Label[Current] = Label[Ancestor];
+    Ancestors[Current] = Ancestors[Ancestor];
+  }
+}
+
+// Vraca cvor sa najmanjim semidominatorom na putanji od korena stabla u sumi do BB
+BasicBlock* DominatorTree::Eval(BasicBlock *BB)
+{
+  if (Ancestors[BB] == nullptr)
+    return BalancedLinking ? Label[BB] : BB;
+
+  Compress(BB);
+
+  if (!BalancedLinking)
+    return Label[BB];
+
+  BasicBlock* AncestorLabel = Label[Ancestors[BB]];
+  return Number(SDom[AncestorLabel]) >= Number(SDom[Label[BB]]) ? Label[BB] : AncestorLabel;
+}
+
+// Bez balansiranja Parent samo postaje predak cvora BB. Sa balansiranjem se stabla u sumi spajaju
+// po velicini, pa je slozenost O(M * alpha(M, N)) umesto O(M * log N). nullptr je strazar
+// velicine 0 i numeracije 0.
+void DominatorTree::Link(BasicBlock *Parent, BasicBlock *BB)
 {
-  Visited.insert(BB);
-  VisitedOrder.push_back(BB);
-  InNumeration[BB] = Time++;
+  if (!BalancedLinking) {
+    Ancestors[BB] = Parent;
+    return;
+  }
+
+  BasicBlock* Root = BB;
+  while (Number(SDom[Label[BB]]) < Number(SDom[Label[Child[Root]]])) {
+    BasicBlock* RootChild = Child[Root];
 
-  for (BasicBlock* CurrentBlock : AdjacencyList[BB]) {
-    if (Visited.find(CurrentBlock) == Visited.end()) {
-      Parents[CurrentBlock] = BB;
-      DFS(CurrentBlock, Time);
+    if (Size[Root] + Size[Child[RootChild]] >= 2 * Size[RootChild]) {
+      Ancestors[RootChild] = Root;
+      Child[Root] = Child[RootChild];
+    } else {
+      Size[RootChild] = Size[Root];
+      Ancestors[Root] = RootChild;
+      Root = RootChild;
     }
   }
+
+  Label[Root] = Label[BB];
+  Size[Parent] += Size[BB];
+  if (Size[Parent] < 2 * Size[BB])
+    std::swap(Root, Child[Parent]);
+
+  while (Root != nullptr) {
+    Ancestors[Root] = Parent;
+    Root = Child[Root];
+  }
 }
 
-void DominatorTree::FindSemiDominatorCandidates(BasicBlock *StartBlock, BasicBlock *CurrentBlock, std::vector<BasicBlock*>& Candidates)
+// Lengauer-Tarjan: semidominatori se racunaju u obrnutom DFS redosledu preko sume sa sabijanjem
+// putanja, a neposredni dominatori se odredjuju implicitno, preko kofa cvorova sa istim
+// semidominatorom, pa u drugom prolazu u DFS redosledu popravljaju.
+void DominatorTree::FindSemiDominators()
 {
-  Visited.insert(CurrentBlock);
+  for (BasicBlock* CurrentBlock : VisitedOrder) {
+    SDom[CurrentBlock] = CurrentBlock;
+    Label[CurrentBlock] = CurrentBlock;
+    Ancestors[CurrentBlock] = nullptr;
+    Child[CurrentBlock] = nullptr;
+    Size[CurrentBlock] = 1;
+  }
+
+  for (auto It = VisitedOrder.rbegin(); It != VisitedOrder.rend(); ++It) {
+    BasicBlock* CurrentBlock = *It;
+    if (CurrentBlock == StartBlock)
+      continue;
+
+    for (BasicBlock* Predecessor : ReversedAdjacencyList[CurrentBlock]) {
+      // Cvorovi koji nisu dostizni iz korena (numeracija 0) ne mogu biti semidominatori
+      if (Number(Predecessor) == 0)
+        continue;
+
+      BasicBlock* Candidate = Eval(Predecessor);
+      if (Number(SDom[Candidate]) < Number(SDom[CurrentBlock]))
+        SDom[CurrentBlock] = SDom[Candidate];
+    }
+
+    BasicBlock* Parent = Parents[CurrentBlock];
+    Bucket[SDom[CurrentBlock]].push_back(CurrentBlock);
+    Link(Parent, CurrentBlock);
+
+    for (BasicBlock* Dominated : Bucket[Parent]) {
+      BasicBlock* Candidate = Eval(Dominated);
+      IDom[Dominated] = Number(SDom[Candidate]) < Number(SDom[Dominated]) ? Candidate : Parent;
+    }
+    Bucket[Parent].clear();
+  }
+}
 
-  if (InNumeration[CurrentBlock] < InNumeration[StartBlock]) {
-    Candidates.push_back(CurrentBlock);
+// Posle inkrementalnih izmena CSR graf vise ne odgovara listama povezanosti, pa se pravi
+// ponovo iz njih; indeksi su pozicije u Blocks. AddEdge vec upisuje nove blokove u Blocks, a
+// blok koji se ipak pojavi samo kao successor dobija sledeci indeks (nikad indeks korena).
+void DominatorTree::BuildDenseGraph()
+{
+  if (!DenseGraphStale)
     return;
+
+  std::unordered_map<BasicBlock*, unsigned> BlockIndex;
+  for (unsigned i = 0; i < Blocks.size(); ++i)
+    BlockIndex[Blocks[i]] = i;
+
+  std::vector<std::pair<unsigned, unsigned>> Edges;
+  for (unsigned i = 0; i < Blocks.size(); ++i) {
+    for (BasicBlock* Successor : AdjacencyList[Blocks[i]]) {
+      auto It = BlockIndex.emplace(Successor, Blocks.size()).first;
+      if (It->second == Blocks.size())
+        Blocks.push_back(Successor);
+      Edges.push_back({i, It->second});
+    }
+  }
+
+  DenseGraph.Build(Blocks.size(), Edges);
+  DenseGraphStale = false;
+}
+
+// Posle DFS-a se radi u prostoru DFS brojeva: cvor k je k-ti poseceni cvor, a roditelj, semi,
+// labela i predak su obicni nizovi indeksirani tim brojem.
+void DominatorTree::DenseDFS(int Start)
+{
+  DenseNumber.assign(Blocks.size(), -1);
+  DenseOrder.clear();
+  DenseParent.clear();
+  DensePostorder.clear();
+
+  DepthFirstSearch(
+      Start,
+      [this](int Current) {
+        return DenseGraph.GetSuccessors(Current);
+      },
+      [this](int Successor, int Current) {
+        if (DenseNumber[Successor] != -1)
+          return false;
+
+        DenseNumber[Successor] = DenseOrder.size();
+        DenseOrder.push_back(Successor);
+        DenseParent.push_back(Successor == Current ? 0 : DenseNumber[Current]);
+        return true;
+      },
+      [this](int Current) {
+        DensePostorder.push_back(Current);
+      });
+}
+
+void DominatorTree::DenseCompress(int Node)
+{
+  std::vector<int> &Path = DensePath;
+  Path.clear();
+
+  while (DenseAncestor[DenseAncestor[Node]] != -1) {
+    Path.push_back(Node);
+    Node = DenseAncestor[Node];
   }
 
-  for (BasicBlock* BB : ReversedAdjacencyList[CurrentBlock]) {
-    if (Visited.find(BB) == Visited.end())
-      FindSemiDominatorCandidates(StartBlock, BB, Candidates);
+  for (auto It = Path.rbegin(); It != Path.rend(); ++It) {
+    int Ancestor = DenseAncestor[*It];
+    if (DenseSemi[DenseLabel[Ancestor]] < DenseSemi[DenseLabel[*It]])
+      DenseLabel[*It] = DenseLabel[Ancestor];
+    DenseAncestor[*It] = DenseAncestor[Ancestor];
   }
 }
 
-BasicBlock* DominatorTree::FindSemiDominator(BasicBlock *CurrentBlock)
+int DominatorTree::DenseEval(int Node)
 {
-  Visited.clear();
-  std::vector<BasicBlock*> Candidates;
+  if (DenseAncestor[Node] == -1)
+    return Node;
+
+  DenseCompress(Node);
+  return DenseLabel[Node];
+}
 
-  FindSemiDominatorCandidates(CurrentBlock, CurrentBlock, Candidates);
+// Semi-NCA: semidominatori se racunaju kao kod Lengauer-Tarjan-a (sa sabijanjem putanja), ali se
+// neposredni dominator dobija kao najblizi zajednicki predak roditelja i semidominatora u vec
+// izgradjenom delu stabla: idom(w) je prvi predak parent(w) u stablu dominatora ciji je DFS broj
+// manji ili jednak semi(w). Nema kofa ni drugog prolaza sa eval-om.
+void DominatorTree::FindImmediateDominatorsSemiNCA()
+{
+  // Koren (ulazni blok, odnosno vestacki izlaz) je uvek prvi u Blocks
+  BuildDenseGraph();
+  DenseDFS(0);
+
+  int NumOfReachable = DenseOrder.size();
+  DenseSemi.resize(NumOfReachable);
+  DenseLabel.resize(NumOfReachable);
+  DenseAncestor.assign(NumOfReachable, -1);
+  DenseIDom.assign(NumOfReachable, 0);
+
+  for (int i = 0; i < NumOfReachable; ++i) {
+    DenseSemi[i] = i;
+    DenseLabel[i] = i;
+  }
 
-  int MinNumeration = std::numeric_limits<int>::max();
-  BasicBlock* SemiDominator = nullptr;
+  for (int w = NumOfReachable - 1; w > 0; --w) {
+    for (int Predecessor : DenseGraph.GetPredecessors(DenseOrder[w])) {
+      int v = DenseNumber[Predecessor];
+      if (v == -1)
+        continue;
 
-  for (BasicBlock* Candidate : Candidates) {
-    if (InNumeration[Candidate] < MinNumeration) {
-      MinNumeration = InNumeration[Candidate];
-      SemiDominator = Candidate;
+      int Candidate = DenseSemi[DenseEval(v)];
+      if (Candidate < DenseSemi[w])
+        DenseSemi[w] = Candidate;
     }
+
+    DenseAncestor[w] = DenseParent[w];
   }
 
-  return SemiDominator;
+  for (int w = 1; w < NumOfReachable; ++w) {
+    int Dominator = DenseParent[w];
+    while (Dominator > DenseSemi[w])
+      Dominator = DenseIDom[Dominator];
+    DenseIDom[w] = Dominator;
+  }
+
+  // Rezultat prepisujemo u iste strukture koje koristi Lengauer-Tarjan, da bi upiti i ispis
+  // radili isto za oba algoritma
+  for (int w = 0; w < NumOfReachable; ++w) {
+    BasicBlock* BB = Blocks[DenseOrder[w]];
+    VisitedOrder.push_back(BB);
+    InNumeration[BB] = w + 1;
+    Parents[BB] = w == 0 ? nullptr : Blocks[DenseOrder[DenseParent[w]]];
+    SDom[BB] = Blocks[DenseOrder[DenseSemi[w]]];
+    IDom[BB] = w == 0 ? nullptr : Blocks[DenseOrder[DenseIDom[w]]];
+  }
 }
 
-void DominatorTree::FindSemiDominators()
+// Blok sa vecim RPO brojem ne moze biti predak bloka sa manjim, pa se on penje po trenutnom stablu
+// dok se dva bloka ne sretnu
+int DominatorTree::DenseIntersect(int A, int B)
+{
+  while (A != B) {
+    while (A > B)
+      A = DenseIDom[A];
+    while (B > A)
+      B = DenseIDom[B];
+  }
+  return A;
+}
+
+// Cooper-Harvey-Kennedy: blokovi se obilaze u RPO-u, a idom bloka je presek (najblizi zajednicki
+// predak u trenutnom stablu) svih prethodnika kojima je idom vec odredjen. Prolazi se ponavljaju
+// dok se nesto menja; za svodljive grafove su dovoljna dva. Nema foresta ni semidominatora, pa je
+// za male funkcije brzi od Semi-NCA, ali na velikim nesvodljivim grafovima treba mnogo prolaza.
+void DominatorTree::FindImmediateDominatorsIterative()
 {
-  std::reverse(VisitedOrder.begin(), VisitedOrder.end());
+  BuildDenseGraph();
+  DenseDFS(0);
+
+  int NumOfReachable = DensePostorder.size();
+  DenseRPONumber.assign(Blocks.size(), -1);
+  for (int r = 0; r < NumOfReachable; ++r)
+    DenseRPONumber[DensePostorder[NumOfReachable - 1 - r]] = r;
+
+  DenseIDom.assign(NumOfReachable, -1);
+  DenseIDom[0] = 0;
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+
+    for (int r = 1; r < NumOfReachable; ++r) {
+      int NewIDom = -1;
+
+      for (int Predecessor : DenseGraph.GetPredecessors(DensePostorder[NumOfReachable - 1 - r])) {
+        int p = DenseRPONumber[Predecessor];
+        if (p == -1 || DenseIDom[p] == -1)
+          continue;
 
-  for (BasicBlock* CurrentBlock : VisitedOrder)
-    SDom[CurrentBlock] = FindSemiDominator(CurrentBlock);
+        NewIDom = NewIDom == -1 ? p : DenseIntersect(p, NewIDom);
+      }
+
+      if (DenseIDom[r] != NewIDom) {
+        DenseIDom[r] = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+
+  // Upiti i inkrementalne izmene rade nad DFS preorder-om kao kod ostalih algoritama; idom je
+  // predak u DFS stablu, pa je u preorder-u uvek pre bloka
+  for (int w = 0; w < (int)DenseOrder.size(); ++w) {
+    BasicBlock* BB = Blocks[DenseOrder[w]];
+    VisitedOrder.push_back(BB);
+    InNumeration[BB] = w + 1;
+    Parents[BB] = w == 0 ? nullptr : Blocks[DenseOrder[DenseParent[w]]];
+
+    int r = DenseRPONumber[DenseOrder[w]];
+    IDom[BB] = w == 0 ? nullptr : Blocks[DensePostorder[NumOfReachable - 1 - DenseIDom[r]]];
+  }
 }
 
 void DominatorTree::FindImmediateDominators()
 {
+  ClearAnalysis();
+
+  DominatorEngine Selected = Engine;
+  if (Selected == DominatorEngine::Auto)
+    Selected = Blocks.size() <= IterativeBlockLimit ? DominatorEngine::Iterative : DominatorEngine::SemiNCA;
+
+  if (Selected == DominatorEngine::SemiNCA) {
+    FindImmediateDominatorsSemiNCA();
+    BuildTreeInfo();
+    return;
+  }
+
+  if (Selected == DominatorEngine::Iterative) {
+    FindImmediateDominatorsIterative();
+    BuildTreeInfo();
+    return;
+  }
+
   DFS(StartBlock, Time);
   FindSemiDominators();
 
-  BasicBlock* Parent = nullptr;
-  BasicBlock* Ancestor = nullptr;
-  int MinNumeration = std::numeric_limits<int>::max();
-
+  IDom[StartBlock] = nullptr;
   for (BasicBlock* CurrentBlock : VisitedOrder) {
-    Parent = Parents[CurrentBlock];
-    MinNumeration = InNumeration[SDom[CurrentBlock]];
+    if (CurrentBlock != StartBlock && IDom[CurrentBlock] != SDom[CurrentBlock])
+      IDom[CurrentBlock] = IDom[IDom[CurrentBlock]];
+  }
+
+  BuildTreeInfo();
+}
+
+void DominatorTree::ClearAnalysis()
+{
+  Time = 1;
+  Parents.clear();
+  Ancestors.clear();
+  Label.clear();
+  Child.clear();
+  Size.clear();
+  Bucket.clear();
+  VisitedOrder.clear();
+  Visited.clear();
+  InNumeration.clear();
+  SDom.clear();
+  IDom.clear();
+  Depth.clear();
+  Children.clear();
+  DominanceFrontiers.clear();
+  DFSNumbersValid = false;
+  LCAIndexValid = false;
+}
+
+// VisitedOrder je DFS preorder, pa je neposredni dominator svakog bloka obradjen pre njega
+void DominatorTree::BuildTreeInfo()
+{
+  for (BasicBlock* BB : VisitedOrder) {
+    Children[BB] = {};
+    if (BB == StartBlock) {
+      Depth[BB] = 0;
+      continue;
+    }
+
+    Depth[BB] = Depth[IDom[BB]] + 1;
+    Children[IDom[BB]].push_back(BB);
+  }
+}
+
+bool DominatorTree::Contains(BasicBlock *BB)
+{
+  return BB != nullptr && InNumeration.find(BB) != InNumeration.end() && InNumeration[BB] != 0;
+}
+
+// Vestacki izlaz se spolja vidi kao nullptr: blok ciji je neposredni postdominator nullptr
+// postdominira samo izlaz iz funkcije.
+BasicBlock* DominatorTree::GetImmediateDominator(BasicBlock *BB)
+{
+  if (!Contains(BB) || BB == StartBlock)
+    return nullptr;
+
+  BasicBlock* Dominator = IDom[BB];
+  return Dominator == VirtualExit ? nullptr : Dominator;
+}
+
+void DominatorTree::SetExportOptions(const GraphExportOptions &NewOptions)
+{
+  ExportOptions = NewOptions;
+}
+
+std::string DominatorTree::GetFileName() const
+{
+  return (IsPostDominatorTree ? "ourpostdom." : "ourdom.") + FunctionName + GetGraphFileExtension(ExportOptions.Format);
+}
+
+std::string DominatorTree::GetTitle() const
+{
+  return (IsPostDominatorTree ? "Post-dominator tree for '" : "Dominator tree for '") + FunctionName + "' function";
+}
+
+// Cvorovi dobijaju brojeve redom kojim su poseceni (koren je 0), a imena blokova se ispisuju kroz
+// jedan ModuleSlotTracker, jer printAsOperand bez njega za svaki neimenovani blok numerise celu
+// funkciju. Vestacki izlaz stabla postdominatora nije u funkciji, ali je imenovan.
+void DominatorTree::Export(GraphExporter &Exporter)
+{
+  std::unique_ptr<ModuleSlotTracker> Slots;
+  if (Snapshot && Snapshot->GetNumOfBlocks() > 0) {
+    Function* F = Snapshot->GetBlock(0)->getParent();
+    Slots = std::make_unique<ModuleSlotTracker>(F->getParent());
+    Slots->incorporateFunction(*F);
+  }
+
+  std::unordered_map<BasicBlock*, unsigned> NodeId;
+  auto GetNodeId = [&NodeId](BasicBlock* BB) {
+    return NodeId.insert({BB, NodeId.size()}).first->second;
+  };
+
+  std::string Name;
+  for (BasicBlock* Current : VisitedOrder) {
+    if (!Contains(Current))
+      continue;
+
+    Name.clear();
+    raw_string_ostream NameStream(Name);
+    if (Slots)
+      Current->printAsOperand(NameStream, false, *Slots);
+    else
+      Current->printAsOperand(NameStream, false);
+    NameStream.flush();
+
+    unsigned Id = GetNodeId(Current);
+    Exporter.AddNode(Id, Name);
+    if (Current != StartBlock)
+      Exporter.AddEdge(GetNodeId(IDom[Current]), Id);
+  }
+}
+
+std::string DominatorTree::ExportToString()
+{
+  GraphExporter Exporter(ExportOptions, GetTitle(), {"#072757", "#2462bf"});
+  std::string Error;
+
+  Export(Exporter);
+  Exporter.Close(Error);
+  return Exporter.GetText();
+}
+
+void DominatorTree::DumpTreeToFile()
+{
+  GraphExporter Exporter(ExportOptions, GetTitle(), {"#072757", "#2462bf"});
+  std::string Error;
+
+  if (!Exporter.Open(GetFileName(), Error)) {
+    errs() << Error << "\n";
+    return;
+  }
+
+  Export(Exporter);
+  if (!Exporter.Close(Error))
+    errs() << Error << "\n";
+}
+
+// Stablo odgovara funkciji dok god DenseCFG vraca isti snimak iz kog je napravljeno
+bool DominatorTree::IsUpToDate(Function &F) const
+{
+  return Snapshot && DenseCFG::Get(F) == Snapshot;
+}
+
+BasicBlock* DominatorTree::CommonDominator(BasicBlock *A, BasicBlock *B)
+{
+  while (Depth[A] > Depth[B])
+    A = IDom[A];
+  while (Depth[B] > Depth[A])
+    B = IDom[B];
+
+  while (A != B) {
+    A = IDom[A];
+    B = IDom[B];
+  }
+
+  return A;
+}
+
+void DominatorTree::SetImmediateDominator(BasicBlock *BB, BasicBlock *NewDominator)
+{
+  auto It = IDom.find(BB);
+  if (It != IDom.end() && It->second != nullptr) {
+    std::vector<BasicBlock*> &Siblings = Children[It->second];
+    Siblings.erase(std::find(Siblings.begin(), Siblings.end(), BB));
+  }
+
+  IDom[BB] = NewDominator;
+  Children[NewDominator].push_back(BB);
+}
 
-    while (Parent != SDom[CurrentBlock]) {
-      if (InNumeration[SDom[Parent]] < MinNumeration) {
-        MinNumeration = InNumeration[SDom[Parent]];
-        Ancestor = Parent;
+// Dubina se od BB spusta kroz celo njegovo podstablo
+void DominatorTree::UpdateDepths(BasicBlock *BB)
+{
+  DepthFirstSearch(
+      BB,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return Children[Current];
+      },
+      [this](BasicBlock *Child, BasicBlock*) {
+        Depth[Child] = Depth[IDom[Child]] + 1;
+        return true;
+      },
+      [](BasicBlock*) {});
+}
+
+std::vector<BasicBlock*> DominatorTree::CollectSubtree(BasicBlock *BB)
+{
+  std::vector<BasicBlock*> Subtree = {BB};
+
+  for (unsigned i = 0; i < Subtree.size(); ++i) {
+    for (BasicBlock* Next : Children[Subtree[i]])
+      Subtree.push_back(Next);
+  }
+
+  return Subtree;
+}
+
+// Semi-NCA nad delom grafa: DFS krece od Root i ulazi samo u blokove za koje InRegion vazi, a
+// prethodnici van posecenog dela se preskacu. Root zadrzava svoj polozaj u stablu, a svi ostali
+// poseceni blokovi dobijaju novog neposrednog dominatora i dubinu. Vraca posecene blokove.
+std::vector<BasicBlock*> DominatorTree::RecomputeRegion(BasicBlock *Root,
+                                                        const std::function<bool(BasicBlock*)> &InRegion)
+{
+  std::unordered_map<BasicBlock*, int> LocalNumber;
+  std::vector<BasicBlock*> Order;
+  std::vector<int> Parent;
+
+  DepthFirstSearch(
+      Root,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return AdjacencyList[Current];
+      },
+      [&](BasicBlock *Successor, BasicBlock *Current) {
+        if (Successor != Root && !InRegion(Successor))
+          return false;
+        if (!LocalNumber.emplace(Successor, Order.size()).second)
+          return false;
+
+        Parent.push_back(Successor == Current ? 0 : LocalNumber[Current]);
+        Order.push_back(Successor);
+        return true;
+      },
+      [](BasicBlock*) {});
+
+  int NumOfVisited = Order.size();
+  DenseSemi.resize(NumOfVisited);
+  DenseLabel.resize(NumOfVisited);
+  DenseAncestor.assign(NumOfVisited, -1);
+  DenseIDom.assign(NumOfVisited, 0);
+
+  for (int i = 0; i < NumOfVisited; ++i) {
+    DenseSemi[i] = i;
+    DenseLabel[i] = i;
+  }
+
+  for (int w = NumOfVisited - 1; w > 0; --w) {
+    for (BasicBlock* Predecessor : ReversedAdjacencyList[Order[w]]) {
+      auto It = LocalNumber.find(Predecessor);
+      if (It == LocalNumber.end())
+        continue;
+
+      int Candidate = DenseSemi[DenseEval(It->second)];
+      if (Candidate < DenseSemi[w])
+        DenseSemi[w] = Candidate;
+    }
+
+    DenseAncestor[w] = Parent[w];
+  }
+
+  for (int w = 1; w < NumOfVisited; ++w) {
+    int Dominator = Parent[w];
+    while (Dominator > DenseSemi[w])
+      Dominator = DenseIDom[Dominator];
+    DenseIDom[w] = Dominator;
+  }
+
+  // Redom DFS-a, pa je dubina novog dominatora vec azurirana
+  for (int w = 1; w < NumOfVisited; ++w) {
+    BasicBlock* BB = Order[w];
+    if (!Contains(BB)) {
+      if (InNumeration.find(BB) == InNumeration.end())
+        VisitedOrder.push_back(BB);
+      InNumeration[BB] = Time++;
+      Children[BB] = {};
+    }
+
+    SetImmediateDominator(BB, Order[DenseIDom[w]]);
+    Depth[BB] = Depth[IDom[BB]] + 1;
+  }
+
+  return Order;
+}
+
+void DominatorTree::RemoveEdge(BasicBlock *From, BasicBlock *To)
+{
+  std::vector<BasicBlock*> &Successors = AdjacencyList[From];
+  std::vector<BasicBlock*> &Predecessors = ReversedAdjacencyList[To];
+  Successors.erase(std::find(Successors.begin(), Successors.end(), To));
+  Predecessors.erase(std::find(Predecessors.begin(), Predecessors.end(), From));
+}
+
+// Umetanje grane izmedju dva dostizna bloka: neposredni dominator postaje NCD = ncd(From, To)
+// samo blokovima do kojih se iz To stize putem cija dubina ne pada ispod dubine bloka u koji se
+// ulazi, a koji su dublje od NCD + 1. Obilazak krece od najdubljih (kofa po dubini), pa se
+// obidje samo pogodjeni deo stabla, ne ceo graf.
+void DominatorTree::InsertReachable(BasicBlock *From, BasicBlock *To)
+{
+  BasicBlock* NCD = CommonDominator(From, To);
+  int NCDLevel = Depth[NCD];
+  if (Depth[To] <= NCDLevel + 1)
+    return;
+
+  std::priority_queue<std::pair<int, BasicBlock*>> Bucket;
+  std::unordered_set<BasicBlock*> Visited = {To};
+  std::vector<BasicBlock*> Affected;
+  Bucket.push({Depth[To], To});
+
+  while (!Bucket.empty()) {
+    BasicBlock* Current = Bucket.top().second;
+    int CurrentLevel = Bucket.top().first;
+    Bucket.pop();
+    Affected.push_back(Current);
+
+    std::vector<BasicBlock*> Stack = {Current};
+    while (!Stack.empty()) {
+      BasicBlock* Next = Stack.back();
+      Stack.pop_back();
+
+      for (BasicBlock* Successor : AdjacencyList[Next]) {
+        if (!Contains(Successor))
+          continue;
+
+        int SuccessorLevel = Depth[Successor];
+        if (SuccessorLevel <= NCDLevel + 1 || !Visited.insert(Successor).second)
+          continue;
+
+        if (SuccessorLevel > CurrentLevel)
+          Stack.push_back(Successor);
+        else
+          Bucket.push({SuccessorLevel, Successor});
       }
+    }
+  }
 
-      Parent = Parents[Parent];
+  for (BasicBlock* BB : Affected)
+    SetImmediateDominator(BB, NCD);
+  for (BasicBlock* BB : Affected)
+    UpdateDepths(BB);
+}
+
+// Grana iz stabla u blok koji do sada nije bio dostizan: novi dostizni deo se racuna lokalno
+// sa From kao korenom (u njega se iz ostatka grafa ne moze uci), a njegove grane ka vec
+// dostiznim blokovima se zatim umecu kao obicne grane.
+void DominatorTree::InsertUnreachable(BasicBlock *From)
+{
+  std::vector<BasicBlock*> Region = RecomputeRegion(From, [this](BasicBlock *BB) {
+    return !Contains(BB);
+  });
+
+  std::unordered_set<BasicBlock*> InRegion(Region.begin() + 1, Region.end());
+  std::vector<std::pair<BasicBlock*, BasicBlock*>> Discovered;
+  for (BasicBlock* BB : InRegion) {
+    for (BasicBlock* Successor : AdjacencyList[BB]) {
+      if (Contains(Successor) && InRegion.find(Successor) == InRegion.end())
+        Discovered.push_back({BB, Successor});
     }
+  }
+
+  for (auto &Edge : Discovered)
+    InsertReachable(Edge.first, Edge.second);
+}
+
+// Brisanje grane menja dominatore samo unutar podstabla NCD = ncd(From, To): u to podstablo se
+// ne ulazi drugacije nego kroz NCD, a iz njega se izlazi samo u blokove dubine najvise
+// dubina(NCD). Blokovi podstabla do kojih se iz NCD vise ne stize postaju nedostizni; tada se
+// menjaju i dominatori blokova u koje su oni vodili, pa se racuna podstablo zajednickog
+// dominatora NCD i svih tih blokova. Ako je to koren, stablo se racuna iz pocetka.
+void DominatorTree::DeleteReachable(BasicBlock *From, BasicBlock *To)
+{
+  BasicBlock* NCD = CommonDominator(From, To);
+  int NCDLevel = Depth[NCD];
 
-    Ancestors[CurrentBlock] = Ancestor;
+  std::unordered_set<BasicBlock*> Reachable;
+  DepthFirstSearch(
+      NCD,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return AdjacencyList[Current];
+      },
+      [&](BasicBlock *Successor, BasicBlock*) {
+        if (Successor != NCD && !(Contains(Successor) && Depth[Successor] > NCDLevel))
+          return false;
+        return Reachable.insert(Successor).second;
+      },
+      [](BasicBlock*) {});
+
+  std::unordered_set<BasicBlock*> Unreachable;
+  for (BasicBlock* BB : CollectSubtree(NCD)) {
+    if (Reachable.find(BB) == Reachable.end())
+      Unreachable.insert(BB);
   }
 
-  std::reverse(VisitedOrder.begin(), VisitedOrder.end());
+  BasicBlock* SubtreeRoot = NCD;
+  for (BasicBlock* BB : Unreachable) {
+    for (BasicBlock* Successor : AdjacencyList[BB]) {
+      if (Contains(Successor) && Unreachable.find(Successor) == Unreachable.end())
+        SubtreeRoot = CommonDominator(SubtreeRoot, Successor);
+    }
+  }
 
-  for (BasicBlock* CurrentBlock : VisitedOrder) {
-    if (Ancestors[CurrentBlock] == nullptr) {
-      IDom[CurrentBlock] = SDom[CurrentBlock];
-    } else {
-      IDom[CurrentBlock] = IDom[Ancestors[CurrentBlock]];
+  for (BasicBlock* BB : Unreachable) {
+    BasicBlock* Dominator = IDom[BB];
+    if (Unreachable.find(Dominator) == Unreachable.end()) {
+      std::vector<BasicBlock*> &Siblings = Children[Dominator];
+      Siblings.erase(std::find(Siblings.begin(), Siblings.end(), BB));
     }
   }
+
+  for (BasicBlock* BB : Unreachable) {
+    InNumeration[BB] = 0;
+    IDom.erase(BB);
+    Depth.erase(BB);
+    Children.erase(BB);
+  }
+
+  if (SubtreeRoot == StartBlock) {
+    FindImmediateDominators();
+    return;
+  }
+
+  int RootLevel = Depth[SubtreeRoot];
+  RecomputeRegion(SubtreeRoot, [this, RootLevel](BasicBlock *BB) {
+    return Contains(BB) && Depth[BB] > RootLevel;
+  });
 }
 
-void DominatorTree::DumpTreeToFile()
+void DominatorTree::InsertGraphEdge(BasicBlock *From, BasicBlock *To, bool UpdateTree)
+{
+  AddEdge(From, To);
+  if (!UpdateTree || !Contains(From))
+    return;
+
+  if (Contains(To))
+    InsertReachable(From, To);
+  else
+    InsertUnreachable(From);
+}
+
+void DominatorTree::DeleteGraphEdge(BasicBlock *From, BasicBlock *To, bool UpdateTree)
 {
-  std::string FileName = "ourdom." + FunctionName + ".dot";
-  std::error_code Error;
+  RemoveEdge(From, To);
+  if (!UpdateTree || !Contains(From) || !Contains(To))
+    return;
 
-  raw_fd_ostream File(FileName, Error);
+  // Ako je ostala paralelna grana (npr. switch sa dva slucaja ka istom bloku), nista se ne menja
+  std::vector<BasicBlock*> &Successors = AdjacencyList[From];
+  if (std::find(Successors.begin(), Successors.end(), To) != Successors.end())
+    return;
 
-  File << "digraph \"Dominator tree for '" << FunctionName << "' function\" {\n";
-  File << "\tlabel=\"Dominator tree for '" << FunctionName << "' function\";\n\n";
+  DeleteReachable(From, To);
+}
 
-  for (BasicBlock* Current : VisitedOrder) {
-    File << "\tNode" << Current << " [shape=record, color=\"#072757\", style=filled, fillcolor=\"#2462bf\"label=\"{";
-    Current->printAsOperand(File, false);
-    File << "}\"];\n";
+// Izmena je zadata u smeru CFG-a. Kod postdominatora se grana obrce, a blok koji postaje (ili
+// prestaje da bude) izlaz dobija (odnosno gubi) granu iz vestackog izlaza; nova grana se uvek
+// dodaje pre nego sto se stara obrise, da blok ne bi nakratko postao nedostizan.
+void DominatorTree::ApplyUpdate(const DominatorTreeUpdate &Update, bool UpdateTree)
+{
+  BasicBlock* From = Update.From;
+  BasicBlock* To = Update.To;
+  DenseGraphStale = true;
+  DominanceFrontiers.clear();
+  DFSNumbersValid = false;
+  LCAIndexValid = false;
+
+  if (!IsPostDominatorTree) {
+    if (Update.Kind == UpdateKind::Insert)
+      InsertGraphEdge(From, To, UpdateTree);
+    else
+      DeleteGraphEdge(From, To, UpdateTree);
+    return;
+  }
+
+  std::vector<BasicBlock*> &Successors = ReversedAdjacencyList[From];
+  if (Update.Kind == UpdateKind::Insert) {
+    bool WasExit = std::find(Successors.begin(), Successors.end(), VirtualExit) != Successors.end();
+    InsertGraphEdge(To, From, UpdateTree);
+    if (WasExit)
+      DeleteGraphEdge(VirtualExit, From, UpdateTree);
+    return;
+  }
+
+  if (Successors.size() == 1)
+    InsertGraphEdge(VirtualExit, From, UpdateTree);
+  DeleteGraphEdge(To, From, UpdateTree);
+}
+
+void DominatorTree::InsertEdge(BasicBlock *From, BasicBlock *To)
+{
+  ApplyUpdate({UpdateKind::Insert, From, To}, true);
+}
 
-    File << "\tNode" << IDom[Current] << " -> Node" << Current << ";\n";
+void DominatorTree::DeleteEdge(BasicBlock *From, BasicBlock *To)
+{
+  ApplyUpdate({UpdateKind::Delete, From, To}, true);
+}
+
+// Umetanje i brisanje iste grane u jednoj grupi se ponistavaju. Ako posle toga ostane mnogo
+// izmena u odnosu na velicinu grafa, jeftinije je primeniti ih samo na graf i racunati stablo
+// iz pocetka; inace se prvo umecu nove grane (tako manje blokova privremeno postane nedostizno).
+void DominatorTree::ApplyUpdates(const std::vector<DominatorTreeUpdate> &Updates)
+{
+  std::map<std::pair<BasicBlock*, BasicBlock*>, int> Balance;
+  std::vector<std::pair<BasicBlock*, BasicBlock*>> EdgeOrder;
+  for (const DominatorTreeUpdate &Update : Updates) {
+    auto Edge = std::make_pair(Update.From, Update.To);
+    if (Balance.find(Edge) == Balance.end())
+      EdgeOrder.push_back(Edge);
+    Balance[Edge] += Update.Kind == UpdateKind::Insert ? 1 : -1;
+  }
+
+  std::vector<DominatorTreeUpdate> Legalized;
+  for (auto &Edge : EdgeOrder) {
+    for (int i = 0; i < Balance[Edge]; ++i)
+      Legalized.push_back({UpdateKind::Insert, Edge.first, Edge.second});
   }
+  for (auto &Edge : EdgeOrder) {
+    for (int i = 0; i > Balance[Edge]; --i)
+      Legalized.push_back({UpdateKind::Delete, Edge.first, Edge.second});
+  }
+
+  bool Recalculate = Legalized.size() > 64 && Legalized.size() * 8 > Blocks.size();
+  for (const DominatorTreeUpdate &Update : Legalized)
+    ApplyUpdate(Update, !Recalculate);
+
+  if (Recalculate)
+    FindImmediateDominators();
+}
+
+// Poredi stablo sa stablom izracunatim iz pocetka nad istim (trenutnim) grafom, za sve blokove iz
+// lista povezanosti (i one dodate posle pravljenja stabla)
+bool DominatorTree::Verify()
+{
+  DominatorTree Fresh;
+  Fresh.FunctionName = FunctionName;
+  Fresh.StartBlock = StartBlock;
+  Fresh.IsPostDominatorTree = IsPostDominatorTree;
+  Fresh.Engine = Engine;
+  Fresh.BalancedLinking = BalancedLinking;
+  Fresh.Blocks = Blocks;
+  Fresh.AdjacencyList = AdjacencyList;
+  Fresh.ReversedAdjacencyList = ReversedAdjacencyList;
+  Fresh.FindImmediateDominators();
 
-  File << "}\n";
-  File.close();
-}
\ No newline at end of file
+  // Dostiznost se proverava i obilaskom lista povezanosti, nezavisno od algoritma (i od CSR grafa)
+  std::unordered_set<BasicBlock*> Reachable;
+  DepthFirstSearch(
+      StartBlock,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return AdjacencyList[Current];
+      },
+      [&Reachable](BasicBlock *Successor, BasicBlock*) {
+        return Reachable.insert(Successor).second;
+      },
+      [](BasicBlock*) {});
+
+  bool Valid = true;
+  for (auto &Entry : AdjacencyList) {
+    BasicBlock* BB = Entry.first;
+    bool IsReachable = Reachable.find(BB) != Reachable.end();
+    if (Contains(BB) != IsReachable || Fresh.Contains(BB) != IsReachable) {
+      errs() << "Dominator tree verification failed in '" << FunctionName << "': block ";
+      BB->printAsOperand(errs(), false);
+      errs() << (IsReachable ? " is reachable\n" : " is not reachable\n");
+      Valid = false;
+      continue;
+    }
+
+    if (!Contains(BB) || BB == StartBlock)
+      continue;
+
+    if (IDom[BB] != Fresh.IDom[BB] || Depth[BB] != Fresh.Depth[BB]) {
+      errs() << "Dominator tree verification failed in '" << FunctionName << "': block ";
+      BB->printAsOperand(errs(), false);
+      errs() << " has immediate dominator ";
+      IDom[BB]->printAsOperand(errs(), false);
+      errs() << ", expected ";
+      Fresh.IDom[BB]->printAsOperand(errs(), false);
+      errs() << "\n";
+      Valid = false;
+    }
+  }
+
+  return Valid;
+}
+
+// Cooper-Harvey-Kennedy: blok B sa bar dva prethodnika je u granici svakog bloka na putu od
+// prethodnika navise kroz stablo, do (ne ukljucujuci) idom(B). Blokovi se obradjuju jedan po
+// jedan, pa je duplikat uvek poslednji element liste.
+void DominatorTree::ComputeDominanceFrontiers()
+{
+  DominanceFrontiers.clear();
+
+  for (BasicBlock* BB : VisitedOrder) {
+    if (!Contains(BB))
+      continue;
+
+    DominanceFrontiers[BB];
+    if (ReversedAdjacencyList[BB].size() < 2)
+      continue;
+
+    for (BasicBlock* Predecessor : ReversedAdjacencyList[BB]) {
+      if (!Contains(Predecessor))
+        continue;
+
+      for (BasicBlock* Runner = Predecessor; Runner != IDom[BB]; Runner = IDom[Runner]) {
+        std::vector<BasicBlock*> &Frontier = DominanceFrontiers[Runner];
+        if (!Frontier.empty() && Frontier.back() == BB)
+          break;
+        Frontier.push_back(BB);
+      }
+    }
+  }
+}
+
+const std::vector<BasicBlock*>& DominatorTree::GetDominanceFrontier(BasicBlock *BB)
+{
+  if (DominanceFrontiers.empty())
+    ComputeDominanceFrontiers();
+
+  return DominanceFrontiers[BB];
+}
+
+// Iterirana granica po Sreedhar-Gao-u, bez pravljenja skupova granica: koreni (blokovi sa
+// definicijom i vec pronadjeni blokovi granice) se obradjuju od najdubljeg, a iz svakog se
+// obilazi njegovo podstablo. Grana X -> Y gde Y nije dete X u stablu (J-grana) daje Y ako Y nije
+// dublji od korena. Svaki blok se obidje najvise jednom, pa je memorija linearna.
+std::vector<BasicBlock*> DominatorTree::FindIteratedDominanceFrontier(const std::vector<BasicBlock*> &DefBlocks)
+{
+  std::priority_queue<std::pair<std::pair<int, int>, BasicBlock*>> Roots;
+  std::unordered_set<BasicBlock*> Defining;
+  std::unordered_set<BasicBlock*> InFrontier;
+  std::unordered_set<BasicBlock*> Visited;
+  std::vector<BasicBlock*> Frontier;
+
+  for (BasicBlock* BB : DefBlocks) {
+    if (Contains(BB) && Defining.insert(BB).second)
+      Roots.push({{Depth[BB], InNumeration[BB]}, BB});
+  }
+
+  std::vector<BasicBlock*> Worklist;
+  while (!Roots.empty()) {
+    BasicBlock* Root = Roots.top().second;
+    int RootLevel = Roots.top().first.first;
+    Roots.pop();
+
+    Worklist.push_back(Root);
+    Visited.insert(Root);
+
+    while (!Worklist.empty()) {
+      BasicBlock* Current = Worklist.back();
+      Worklist.pop_back();
+
+      for (BasicBlock* Successor : AdjacencyList[Current]) {
+        if (!Contains(Successor) || IDom[Successor] == Current)
+          continue;
+
+        if (Depth[Successor] > RootLevel || !InFrontier.insert(Successor).second)
+          continue;
+
+        Frontier.push_back(Successor);
+        if (Defining.find(Successor) == Defining.end())
+          Roots.push({{Depth[Successor], InNumeration[Successor]}, Successor});
+      }
+
+      for (BasicBlock* Next : Children[Current]) {
+        if (Visited.insert(Next).second)
+          Worklist.push_back(Next);
+      }
+    }
+  }
+
+  std::sort(Frontier.begin(), Frontier.end(), [this](BasicBlock *A, BasicBlock *B) {
+    return InNumeration[A] < InNumeration[B];
+  });
+  return Frontier;
+}
+
+void DominatorTree::UpdateDFSNumbers()
+{
+  int Counter = 0;
+  DFSInterval.clear();
+
+  DepthFirstSearch(
+      StartBlock,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return Children[Current];
+      },
+      [this, &Counter](BasicBlock *Child, BasicBlock*) {
+        DFSInterval[Child].first = Counter++;
+        return true;
+      },
+      [this, &Counter](BasicBlock *Current) {
+        DFSInterval[Current].second = Counter++;
+      });
+
+  DFSNumbersValid = true;
+}
+
+// Kao u LLVM-u: svaki blok dominira nedostizan blok, a nedostizan blok ne dominira ni jedan dostizan
+bool DominatorTree::Dominates(BasicBlock *A, BasicBlock *B)
+{
+  if (A == B)
+    return true;
+
+  if (!DFSNumbersValid)
+    UpdateDFSNumbers();
+
+  // Intervale imaju tacno blokovi koji su u stablu
+  auto IntervalB = DFSInterval.find(B);
+  if (IntervalB == DFSInterval.end())
+    return true;
+  auto IntervalA = DFSInterval.find(A);
+  if (IntervalA == DFSInterval.end())
+    return false;
+
+  return IntervalA->second.first <= IntervalB->second.first &&
+         IntervalB->second.second <= IntervalA->second.second;
+}
+
+bool DominatorTree::ProperlyDominates(BasicBlock *A, BasicBlock *B)
+{
+  return A != B && Dominates(A, B);
+}
+
+// Blok se numerise pri prvom upitu; instrukcija koje nema u kesu (dodata posle numeracije)
+// znaci da je kes zastareo, pa se blok numerise ponovo
+bool DominatorTree::ComesBefore(const Instruction *A, const Instruction *B)
+{
+  BasicBlock* BB = const_cast<BasicBlock*>(A->getParent());
+  std::unordered_map<const Instruction*, unsigned> &Order = InstructionOrder[BB];
+
+  auto ItA = Order.find(A);
+  auto ItB = Order.find(B);
+  if (ItA == Order.end() || ItB == Order.end()) {
+    Order.clear();
+    unsigned Position = 0;
+    for (Instruction &I : *BB)
+      Order[&I] = Position++;
+
+    ItA = Order.find(A);
+    ItB = Order.find(B);
+  }
+
+  return ItA->second < ItB->second;
+}
+
+// Za stablo postdominatora instrukcija postdominira one ispred sebe u istom bloku
+bool DominatorTree::Dominates(const Instruction *A, const Instruction *B)
+{
+  BasicBlock* BlockA = const_cast<BasicBlock*>(A->getParent());
+  BasicBlock* BlockB = const_cast<BasicBlock*>(B->getParent());
+
+  if (BlockA != BlockB)
+    return Dominates(BlockA, BlockB);
+  if (A == B)
+    return true;
+
+  return IsPostDominatorTree ? ComesBefore(B, A) : ComesBefore(A, B);
+}
+
+// Poziva se kada se instrukcije u bloku obrisu ili premeste
+void DominatorTree::InvalidateInstructionOrder(BasicBlock *BB)
+{
+  InstructionOrder.erase(BB);
+}
+
+// Stablo nema ciklusa, pa je svaki cvor nov. Posle svakog deteta se u obilazak ponovo upisuje
+// roditelj.
+void DominatorTree::BuildLCAIndex()
+{
+  EulerTour.clear();
+  EulerDepth.clear();
+  FirstOccurrence.clear();
+
+  DepthFirstSearch(
+      StartBlock,
+      [this](BasicBlock *Current) -> std::vector<BasicBlock*>& {
+        return Children[Current];
+      },
+      [this](BasicBlock *Child, BasicBlock*) {
+        FirstOccurrence[Child] = EulerTour.size();
+        EulerTour.push_back(Child);
+        EulerDepth.push_back(Depth[Child]);
+        return true;
+      },
+      [this](BasicBlock *Current) {
+        if (Current == StartBlock)
+          return;
+
+        EulerTour.push_back(IDom[Current]);
+        EulerDepth.push_back(Depth[Current] - 1);
+      });
+
+  unsigned TourSize = EulerTour.size();
+  SparseTable.assign(Log2_32(TourSize) + 1, {});
+  SparseTable[0].resize(TourSize);
+  for (unsigned i = 0; i < TourSize; ++i)
+    SparseTable[0][i] = i;
+
+  for (unsigned k = 1; k < SparseTable.size(); ++k) {
+    unsigned Half = 1u << (k - 1);
+    SparseTable[k].resize(TourSize - (1u << k) + 1);
+
+    for (unsigned i = 0; i < SparseTable[k].size(); ++i) {
+      int Left = SparseTable[k - 1][i];
+      int Right = SparseTable[k - 1][i + Half];
+      SparseTable[k][i] = EulerDepth[Left] <= EulerDepth[Right] ? Left : Right;
+    }
+  }
+
+  LCAIndexValid = true;
+}
+
+// Dva preklapajuca intervala duzine 2^k pokrivaju [First, Last]
+BasicBlock* DominatorTree::ShallowestInRange(int First, int Last)
+{
+  unsigned k = Log2_32(Last - First + 1);
+  int Left = SparseTable[k][First];
+  int Right = SparseTable[k][Last - (1 << k) + 1];
+  return EulerTour[EulerDepth[Left] <= EulerDepth[Right] ? Left : Right];
+}
+
+// Najblizi zajednicki dominator je najplici blok u Ojlerovom obilasku izmedju prvih pojavljivanja
+// dva bloka. Za stablo postdominatora vestacki izlaz se vraca kao nullptr.
+BasicBlock* DominatorTree::FindNearestCommonDominator(BasicBlock *A, BasicBlock *B)
+{
+  if (!LCAIndexValid)
+    BuildLCAIndex();
+
+  auto FirstA = FirstOccurrence.find(A);
+  auto FirstB = FirstOccurrence.find(B);
+  if (FirstA == FirstOccurrence.end() || FirstB == FirstOccurrence.end())
+    return nullptr;
+
+  BasicBlock* Dominator = ShallowestInRange(std::min(FirstA->second, FirstB->second),
+                                            std::max(FirstA->second, FirstB->second));
+  return Dominator == VirtualExit ? nullptr : Dominator;
+}
+
+// Za skup blokova je dovoljno uzeti opseg od najranijeg do najkasnijeg prvog pojavljivanja
+BasicBlock* DominatorTree::FindNearestCommonDominator(const std::vector<BasicBlock*> &BlockSet)
+{
+  if (BlockSet.empty())
+    return nullptr;
+
+  if (!LCAIndexValid)
+    BuildLCAIndex();
+
+  int First = std::numeric_limits<int>::max();
+  int Last = -1;
+  for (BasicBlock* BB : BlockSet) {
+    auto It = FirstOccurrence.find(BB);
+    if (It == FirstOccurrence.end())
+      return nullptr;
+
+    First = std::min(First, It->second);
+    Last = std::max(Last, It->second);
+  }
+
+  BasicBlock* Dominator = ShallowestInRange(First, Last);
+  return Dominator == VirtualExit ? nullptr : Dominator;
+}
@@ -8,7 +8,11 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/BasicBlock.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "../Graph/GraphExporter.h"
 
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 #include <limits>
@@ -16,6 +20,32 @@
 
 using namespace llvm;
 
+// Algoritam kojim se racunaju neposredni dominatori. Iterative je Cooper-Harvey-Kennedy nad RPO-om,
+// a Auto bira Iterative za funkcije do IterativeBlockLimit blokova i Semi-NCA za vece.
+enum class DominatorEngine {
+  LengauerTarjan,
+  SemiNCA,
+  Iterative,
+  Auto
+};
+
+// Granica izmerena alatom Dominators (isto sto i iterative_vertex_limit tamo): do oko 64 cvora je
+// iterativni algoritam jednako brz ili brzi od Semi-NCA, a posle je sporiji, na nesvodljivim
+// grafovima i kvadratno.
+const unsigned IterativeBlockLimit = 64;
+
+// Izmena grane u CFG-u (From -> To), u smeru grane u funkciji i za stablo postdominatora
+enum class UpdateKind {
+  Insert,
+  Delete
+};
+
+struct DominatorTreeUpdate {
+  UpdateKind Kind;
+  BasicBlock* From;
+  BasicBlock* To;
+};
+
 class DominatorTree {
 private:
   // U ovom slucaju cvorovi u grafu su nam BasicBlock-ovi
@@ -24,7 +54,36 @@ private:
   std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> AdjacencyList;
   std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> ReversedAdjacencyList;
   std::unordered_map<BasicBlock*, BasicBlock*> Parents;
+
+  // Suma za Lengauer-Tarjan: predak u sumi, cvor sa najmanjim semidominatorom na putanji do
+  // pretka (labela), a za balansirano povezivanje i velicina i dete svakog stabla.
   std::unordered_map<BasicBlock*, llvm::BasicBlock*> Ancestors;
+  std::unordered_map<BasicBlock*, BasicBlock*> Label;
+  std::unordered_map<BasicBlock*, BasicBlock*> Child;
+  std::unordered_map<BasicBlock*, int> Size;
+  // semidominator -> cvorovi koje on semidominira, a ciji neposredni dominator jos nije odredjen
+  std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> Bucket;
+  bool BalancedLinking;
+  DominatorEngine Engine;
+
+  // Semi-NCA radi nad gustom numeracijom: Blocks[i] je BasicBlock sa indeksom i u CSR grafu, a
+  // svi ostali nizovi posle DFS-a su indeksirani DFS brojem (DenseOrder[k] je indeks k-tog
+  // posecenog bloka). Posle izmena grana CSR graf zastareva i pravi se ponovo pri racunanju.
+  std::vector<BasicBlock*> Blocks;
+  CSRGraph DenseGraph;
+  bool DenseGraphStale;
+  std::vector<int> DenseNumber;
+  std::vector<int> DenseOrder;
+  std::vector<int> DenseParent;
+  std::vector<int> DenseSemi;
+  std::vector<int> DenseLabel;
+  std::vector<int> DenseAncestor;
+  std::vector<int> DenseIDom;
+  std::vector<int> DensePath;
+  // Za iterativni algoritam: DFS postorder (indeksi u Blocks) i RPO broj svakog bloka (-1 ako
+  // nije dostizan). Tada je DenseIDom indeksiran RPO brojem.
+  std::vector<int> DensePostorder;
+  std::vector<int> DenseRPONumber;
 
   std::vector<BasicBlock*> VisitedOrder;
   std::unordered_set<BasicBlock*> Visited;
@@ -32,19 +91,114 @@ private:
 
   std::unordered_map<BasicBlock*, BasicBlock*> SDom;
   std::unordered_map<BasicBlock*, BasicBlock*> IDom;
+
+  // Dubina i deca u stablu dominatora, potrebni za inkrementalne izmene. Posle izmena
+  // InNumeration vise nije DFS numeracija, vec samo oznaka da je blok u stablu (razlicito od 0).
+  std::unordered_map<BasicBlock*, int> Depth;
+  std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> Children;
+
+  // Granice dominacije, racunaju se tek na zahtev i brisu pri svakoj izmeni stabla
+  std::unordered_map<BasicBlock*, std::vector<BasicBlock*>> DominanceFrontiers;
+
+  // Intervali [ulaz, izlaz] DFS obilaska stabla dominatora: A dominira B akko interval od B lezi
+  // u intervalu od A. Racunaju se pri prvom upitu posle izmene stabla.
+  bool DFSNumbersValid;
+  std::unordered_map<BasicBlock*, std::pair<int, int>> DFSInterval;
+
+  // Indeks za najblizi zajednicki dominator: Ojlerov obilazak stabla (blok posle svakog deteta
+  // ponovo), prvo pojavljivanje svakog bloka i retka tabela (sparse table) minimuma dubine nad
+  // obilaskom. SparseTable[k][i] je pozicija najpliceg bloka u EulerTour[i .. i + 2^k - 1].
+  bool LCAIndexValid;
+  std::vector<BasicBlock*> EulerTour;
+  std::vector<int> EulerDepth;
+  std::unordered_map<BasicBlock*, int> FirstOccurrence;
+  std::vector<std::vector<int>> SparseTable;
+
+  // Redni brojevi instrukcija u bloku, za dominaciju unutar istog bloka
+  std::unordered_map<BasicBlock*, std::unordered_map<const Instruction*, unsigned>> InstructionOrder;
+
+  // Kod stabla postdominatora graf je obrnut, a koren je vestacki izlazni cvor u koji vode svi
+  // BasicBlock-ovi bez successora (ret, unreachable). On ne pripada funkciji.
+  bool IsPostDominatorTree;
+  BasicBlock* VirtualExit;
+
+  // Snimak CFG-a iz kog je stablo napravljeno, da bi kes stabala znao kada je funkcija izmenjena
+  std::shared_ptr<const DenseCFG> Snapshot;
+  GraphExportOptions ExportOptions;
+
+  int Number(BasicBlock*);
+  void Compress(BasicBlock*);
+  BasicBlock* Eval(BasicBlock*);
+  void Link(BasicBlock*, BasicBlock*);
+
+  void AddBlock(BasicBlock*);
+  void BuildDenseGraph();
+  void DenseDFS(int);
+  void DenseCompress(int);
+  int DenseEval(int);
+  void FindImmediateDominatorsSemiNCA();
+  int DenseIntersect(int, int);
+  void FindImmediateDominatorsIterative();
+
+  DominatorTree();
+  void ClearAnalysis();
+  void BuildTreeInfo();
+  void SetImmediateDominator(BasicBlock*, BasicBlock*);
+  void UpdateDepths(BasicBlock*);
+  BasicBlock* CommonDominator(BasicBlock*, BasicBlock*);
+  std::vector<BasicBlock*> CollectSubtree(BasicBlock*);
+  std::vector<BasicBlock*> RecomputeRegion(BasicBlock*, const std::function<bool(BasicBlock*)>&);
+  void RemoveEdge(BasicBlock*, BasicBlock*);
+  void InsertGraphEdge(BasicBlock*, BasicBlock*, bool);
+  void DeleteGraphEdge(BasicBlock*, BasicBlock*, bool);
+  void InsertReachable(BasicBlock*, BasicBlock*);
+  void InsertUnreachable(BasicBlock*);
+  void DeleteReachable(BasicBlock*, BasicBlock*);
+  void ApplyUpdate(const DominatorTreeUpdate&, bool);
+  void UpdateDFSNumbers();
+  void BuildLCAIndex();
+  BasicBlock* ShallowestInRange(int, int);
+  bool ComesBefore(const Instruction*, const Instruction*);
+  std::string GetTitle() const;
+  void Export(GraphExporter&);
 public:
   std::string FunctionName;
   BasicBlock* StartBlock;
 
-  DominatorTree(Function&);
+  DominatorTree(Function&, bool PostDominators = false);
+  ~DominatorTree();
 
+  void SetBalancedLinking(bool);
+  void SetEngine(DominatorEngine);
   void AddEdge(BasicBlock*, BasicBlock*);
   void DFS(BasicBlock*, int&);
   void FindSemiDominators();
-  BasicBlock* FindSemiDominator(BasicBlock*);
-  void FindSemiDominatorCandidates(BasicBlock*, BasicBlock*, std::vector<BasicBlock*>&);
   void FindImmediateDominators();
+  void SetExportOptions(const GraphExportOptions&);
+  std::string GetFileName() const;
   void DumpTreeToFile();
+  // Ceo graf stabla u izabranom formatu, za upis iz druge niti
+  std::string ExportToString();
+  bool IsUpToDate(Function&) const;
+
+  bool Contains(BasicBlock*);
+  BasicBlock* GetImmediateDominator(BasicBlock*);
+  BasicBlock* FindNearestCommonDominator(BasicBlock*, BasicBlock*);
+  BasicBlock* FindNearestCommonDominator(const std::vector<BasicBlock*>&);
+
+  bool Dominates(BasicBlock*, BasicBlock*);
+  bool ProperlyDominates(BasicBlock*, BasicBlock*);
+  bool Dominates(const Instruction*, const Instruction*);
+  void InvalidateInstructionOrder(BasicBlock*);
+
+  void ComputeDominanceFrontiers();
+  const std::vector<BasicBlock*>& GetDominanceFrontier(BasicBlock*);
+  std::vector<BasicBlock*> FindIteratedDominanceFrontier(const std::vector<BasicBlock*>&);
+
+  void InsertEdge(BasicBlock*, BasicBlock*);
+  void DeleteEdge(BasicBlock*, BasicBlock*);
+  void ApplyUpdates(const std::vector<DominatorTreeUpdate>&);
+  bool Verify();
 };
 
 #endif // LLVM_PROJECT_DOMINATORTREE_H
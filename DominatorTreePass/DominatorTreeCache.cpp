@@ -0,0 +1,100 @@
+#include "DominatorTreeCache.h"
+#include "../Graph/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+static std::map<std::pair<Function*, bool>, std::shared_ptr<DominatorTree>> Cache;
+static std::mutex CacheLock;
+static DominatorEngine Engine = DominatorEngine::Auto;
+static bool BalancedLinking = false;
+static GraphExportOptions ExportOptions;
+
+void DominatorTreeCache::SetEngine(DominatorEngine NewEngine)
+{
+  Engine = NewEngine;
+}
+
+void DominatorTreeCache::SetBalancedLinking(bool NewBalancedLinking)
+{
+  BalancedLinking = NewBalancedLinking;
+}
+
+void DominatorTreeCache::SetExportOptions(const GraphExportOptions &NewOptions)
+{
+  ExportOptions = NewOptions;
+}
+
+std::shared_ptr<DominatorTree> DominatorTreeCache::Get(Function &F, bool PostDominators)
+{
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  std::shared_ptr<DominatorTree> &Entry = Cache[{&F, PostDominators}];
+
+  if (!Entry || !Entry->IsUpToDate(F)) {
+    Entry = std::make_shared<DominatorTree>(F, PostDominators);
+    Entry->SetEngine(Engine);
+    Entry->SetBalancedLinking(BalancedLinking);
+    Entry->FindImmediateDominators();
+  }
+
+  Entry->SetExportOptions(ExportOptions);
+  return Entry;
+}
+
+void DominatorTreeCache::ComputeModule(Module &M, bool PostDominators, unsigned NumOfThreads, bool DumpToFiles)
+{
+  std::vector<std::pair<Function*, std::shared_ptr<DominatorTree>>> Trees;
+
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    auto Tree = std::make_shared<DominatorTree>(F, PostDominators);
+    Tree->SetEngine(Engine);
+    Tree->SetBalancedLinking(BalancedLinking);
+    Tree->SetExportOptions(ExportOptions);
+    Trees.push_back({&F, Tree});
+  }
+
+  // Jedna nit za upis, da se fajlovi ne bi pisali istovremeno sa racunanjem u svim nitima; svaki
+  // posao u nju predaje ceo fajl ispisan u bafer
+  ThreadPool Writer(1);
+  {
+    ThreadPool Workers(NumOfThreads);
+
+    for (auto &Entry : Trees) {
+      DominatorTree *Tree = Entry.second.get();
+
+      Workers.Async([Tree, DumpToFiles, &Writer] {
+        Tree->FindImmediateDominators();
+        if (!DumpToFiles)
+          return;
+
+        Writer.Async([FileName = Tree->GetFileName(), Text = Tree->ExportToString()] {
+          std::string Error;
+          if (!GraphExporter::WriteFile(FileName, Text, Error))
+            errs() << Error << "\n";
+        });
+      });
+    }
+
+    Workers.Wait();
+  }
+  Writer.Wait();
+
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  for (auto &Entry : Trees)
+    Cache[{Entry.first, PostDominators}] = std::move(Entry.second);
+}
+
+void DominatorTreeCache::Clear()
+{
+  {
+    std::lock_guard<std::mutex> Guard(CacheLock);
+    Cache.clear();
+  }
+  // Stabla drze grafove iz kesa DenseCFG-a, pa se i on prazni kada se stabla vise ne traze
+  DenseCFG::Clear();
+}
@@ -0,0 +1,34 @@
+#ifndef LLVM_PROJECT_DOMINATORTREECACHE_H
+#define LLVM_PROJECT_DOMINATORTREECACHE_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "DominatorTree.h"
+
+#include <memory>
+
+using namespace llvm;
+
+// Izracunata stabla dominatora i postdominatora po funkciji, zajednicka za pasove u istom plugin-u.
+// Get vraca stablo iz kesa ako funkcija od tada nije menjana (isti DenseCFG snimak), a inace ga
+// racuna ponovo. Algoritam, povezivanje i format ispisa se zadaju jednom za sve (Set*), pre Get-a.
+//
+// ComputeModule racuna stabla svih funkcija modula na vise niti: stabla su nezavisna, pa svaka nit
+// racuna svoje, a fajlovi se pisu u posebnoj niti dok se ostala stabla racunaju.
+//
+// Stabla se prave (konstruktor cita IR i za postdominatore pravi vestacki izlaz u LLVMContext-u) na
+// niti koja poziva ComputeModule, a u nitima se samo racunaju i ispisuju. Get i upiti nad vracenim
+// stablom nisu za istovremeno pozivanje iz vise niti. Clear mora da se pozove pre nego sto se
+// unisti LLVMContext (npr. u doFinalization), jer stabla postdominatora brisu svoj vestacki izlaz.
+class DominatorTreeCache {
+public:
+  static void SetEngine(DominatorEngine);
+  static void SetBalancedLinking(bool);
+  static void SetExportOptions(const GraphExportOptions&);
+
+  static std::shared_ptr<DominatorTree> Get(Function&, bool PostDominators = false);
+  static void ComputeModule(Module&, bool PostDominators, unsigned NumOfThreads, bool DumpToFiles);
+  static void Clear();
+};
+
+#endif // LLVM_PROJECT_DOMINATORTREECACHE_H
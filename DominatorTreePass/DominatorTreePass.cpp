@@ -1,9 +1,166 @@
 #include "llvm/IR/Function.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
 #include "DominatorTree.h"
+#include "DominatorTreeCache.h"
+#include "LoopNestingForest.h"
 
 using namespace llvm;
 
+static cl::opt<bool> BalancedLinking("dom-balanced-link", cl::init(false),
+                                     cl::desc("Link trees in the Lengauer-Tarjan forest by size"));
+static cl::opt<DominatorEngine> Engine("dom-engine", cl::init(DominatorEngine::LengauerTarjan),
+                                       cl::desc("Algorithm used to compute immediate dominators"),
+                                       cl::values(clEnumValN(DominatorEngine::LengauerTarjan, "lt", "Lengauer-Tarjan"),
+                                                  clEnumValN(DominatorEngine::SemiNCA, "snca", "Semi-NCA on dense block numbering"),
+                                                  clEnumValN(DominatorEngine::Iterative, "iterative",
+                                                             "Cooper-Harvey-Kennedy iteration over reverse postorder"),
+                                                  clEnumValN(DominatorEngine::Auto, "auto",
+                                                             "Iterative for small functions, Semi-NCA otherwise")));
+static cl::opt<GraphFormat> Format("dom-format", cl::init(GraphFormat::Dot),
+                                   cl::desc("Format of the dominator tree files"),
+                                   cl::values(clEnumValN(GraphFormat::Dot, "dot", "Graphviz .dot"),
+                                              clEnumValN(GraphFormat::Json, "json", "JSON with nodes and edges"),
+                                              clEnumValN(GraphFormat::EdgeList, "edges", "Edge list")));
+static cl::opt<unsigned> NumOfThreads("dom-threads", cl::init(0),
+                                      cl::desc("Worker threads for the module-wide dominator tree passes "
+                                               "(0 means one per core)"));
+static cl::opt<bool> VerifyUpdates("dom-verify-updates", cl::init(false),
+                                   cl::desc("Delete and reinsert every CFG edge incrementally and check the tree "
+                                            "against a full recompute after each update"));
+static cl::opt<bool> PrintFrontiers("dom-print-frontiers", cl::init(false),
+                                    cl::desc("Print dominance frontiers and, for the dominator tree, "
+                                             "the phi blocks of every entry-block alloca"));
+
+// Svaka grana se brise i vraca pojedinacno, a zatim sve izlazne grane svakog drugog bloka u
+// jednoj grupi. Graf je na kraju isti kao na pocetku, pa i stablo mora biti isto.
+//
+// Na kraju se, nad posebnim stablom, svaka grana deli novim blokom koji nije u funkciji (kao
+// SplitCriticalEdge) i zatim se brisu i grane iz izvora u druge successore. Novi blok mora da dobije
+// svoj indeks u gustom grafu: za dijamant b0 -> {b1, b2}, b1 -> b2 deljenje b1 -> b2 i brisanje
+// b0 -> b2 ostavlja b2 i novi blok dostizne samo kroz b1.
+static void VerifyIncrementalUpdates(DominatorTree *Tree, Function &F, bool PostDominators)
+{
+  std::vector<DominatorTreeUpdate> Deletions;
+  std::vector<DominatorTreeUpdate> Insertions;
+  unsigned NumOfUpdates = 0;
+  bool Valid = true;
+
+  unsigned Index = 0;
+  for (BasicBlock &BB : F) {
+    for (BasicBlock* Successor : successors(&BB)) {
+      Tree->DeleteEdge(&BB, Successor);
+      Valid &= Tree->Verify();
+      Tree->InsertEdge(&BB, Successor);
+      Valid &= Tree->Verify();
+      NumOfUpdates += 2;
+
+      if (Index % 2 == 0) {
+        Deletions.push_back({UpdateKind::Delete, &BB, Successor});
+        Insertions.push_back({UpdateKind::Insert, &BB, Successor});
+      }
+    }
+    Index++;
+  }
+
+  Tree->ApplyUpdates(Deletions);
+  Valid &= Tree->Verify();
+  Tree->ApplyUpdates(Insertions);
+  Valid &= Tree->Verify();
+  NumOfUpdates += Deletions.size() + Insertions.size();
+
+  BasicBlock* Split = BasicBlock::Create(F.getContext(), "split");
+  for (BasicBlock &BB : F) {
+    for (BasicBlock* Successor : successors(&BB)) {
+      DominatorTree SplitTree(F, PostDominators);
+      SplitTree.SetEngine(Engine);
+      SplitTree.SetBalancedLinking(BalancedLinking);
+      SplitTree.FindImmediateDominators();
+
+      SplitTree.InsertEdge(&BB, Split);
+      SplitTree.InsertEdge(Split, Successor);
+      SplitTree.DeleteEdge(&BB, Successor);
+      Valid &= SplitTree.Verify();
+      NumOfUpdates += 3;
+
+      for (BasicBlock* Other : successors(&BB)) {
+        if (Other != Successor) {
+          SplitTree.DeleteEdge(&BB, Other);
+          NumOfUpdates++;
+        }
+      }
+      Valid &= SplitTree.Verify();
+    }
+  }
+  delete Split;
+
+  errs() << "Incremental updates for '" << F.getName() << "': " << NumOfUpdates
+         << (Valid ? " updates verified\n" : " updates, verification failed\n");
+}
+
+static void PrintBlockList(const std::vector<BasicBlock*> &List)
+{
+  errs() << "{";
+  for (BasicBlock* BB : List) {
+    errs() << " ";
+    BB->printAsOperand(errs(), false);
+  }
+  errs() << " }\n";
+}
+
+// Blokovi u koje bi mem2reg stavio phi za alokaciju su iterirana granica blokova sa store-om
+static void PrintDominanceFrontiers(DominatorTree *Tree, Function &F, bool PhiBlocks)
+{
+  for (BasicBlock &BB : F) {
+    if (!Tree->Contains(&BB))
+      continue;
+
+    errs() << "DF(";
+    BB.printAsOperand(errs(), false);
+    errs() << ") = ";
+    PrintBlockList(Tree->GetDominanceFrontier(&BB));
+  }
+
+  if (!PhiBlocks)
+    return;
+
+  for (Instruction &I : F.getEntryBlock()) {
+    if (!isa<AllocaInst>(&I))
+      continue;
+
+    std::vector<BasicBlock*> DefBlocks;
+    for (User* U : I.users()) {
+      StoreInst* Store = dyn_cast<StoreInst>(U);
+      if (Store && Store->getPointerOperand() == &I)
+        DefBlocks.push_back(Store->getParent());
+    }
+
+    errs() << "Phi blocks for ";
+    I.printAsOperand(errs(), false);
+    errs() << ": ";
+    PrintBlockList(Tree->FindIteratedDominanceFrontier(DefBlocks));
+  }
+}
+
+// Podesavanja iz komandne linije vaze za sva stabla u kesu, pa i za ona koja racunaju pasovi za ceo modul
+static void ConfigureCache()
+{
+  DominatorTreeCache::SetEngine(Engine);
+  DominatorTreeCache::SetBalancedLinking(BalancedLinking);
+  DominatorTreeCache::SetExportOptions({Format, false});
+}
+
+// Provera inkrementalnog azuriranja i ispis granica dominacije nad stablima iz kesa, na niti koja
+// poziva (upiti nad stablima nisu za vise niti)
+static void CheckAndPrint(DominatorTree *Tree, Function &F, bool PostDominators)
+{
+  if (VerifyUpdates)
+    VerifyIncrementalUpdates(Tree, F, PostDominators);
+  if (PrintFrontiers)
+    PrintDominanceFrontiers(Tree, F, !PostDominators);
+}
+
 namespace {
 // Hello - The first implementation, without getAnalysisUsage.
 struct OurDominatorTreePass : public FunctionPass {
@@ -11,12 +168,98 @@ struct OurDominatorTreePass : public FunctionPass {
   OurDominatorTreePass() : FunctionPass(ID) {}
 
   bool runOnFunction(Function &F) override {
-    DominatorTree* DomTree = new DominatorTree(F);
+    ConfigureCache();
+    std::shared_ptr<DominatorTree> DomTree = DominatorTreeCache::Get(F);
 
-    DomTree->FindImmediateDominators();
+    CheckAndPrint(DomTree.get(), F, false);
     DomTree->DumpTreeToFile();
+    return false;
+  }
 
-    delete DomTree;
+  bool doFinalization(Module &M) override {
+    DominatorTreeCache::Clear();
+    return false;
+  }
+};
+
+struct OurPostDominatorTreePass : public FunctionPass {
+  static char ID;
+  OurPostDominatorTreePass() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override {
+    ConfigureCache();
+    std::shared_ptr<DominatorTree> PostDomTree = DominatorTreeCache::Get(F, true);
+
+    CheckAndPrint(PostDomTree.get(), F, true);
+    PostDomTree->DumpTreeToFile();
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DominatorTreeCache::Clear();
+    return false;
+  }
+};
+
+// Ako je pre ovog pasa pokrenut print-our-dominator-trees, stabla se uzimaju iz kesa
+struct OurLoopsPass : public FunctionPass {
+  static char ID;
+  OurLoopsPass() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override {
+    ConfigureCache();
+    std::shared_ptr<DominatorTree> DomTree = DominatorTreeCache::Get(F);
+
+    LoopNestingForest Forest(F, *DomTree);
+    errs() << "Loops in '" << F.getName() << "':\n";
+    Forest.Print(errs());
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DominatorTreeCache::Clear();
+    return false;
+  }
+};
+
+// Stabla svih funkcija modula se racunaju paralelno i ostaju u DominatorTreeCache-u do kraja rada
+// pass manager-a, da bi ih ostali pasovi koristili bez ponovnog racunanja
+struct OurModuleDominatorTreePass : public ModulePass {
+  static char ID;
+  OurModuleDominatorTreePass() : ModulePass(ID) {}
+
+  bool runOnModule(Module &M) override {
+    ConfigureCache();
+    DominatorTreeCache::ComputeModule(M, false, NumOfThreads, true);
+
+    for (Function &F : M)
+      if (!F.isDeclaration())
+        CheckAndPrint(DominatorTreeCache::Get(F).get(), F, false);
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DominatorTreeCache::Clear();
+    return false;
+  }
+};
+
+struct OurModulePostDominatorTreePass : public ModulePass {
+  static char ID;
+  OurModulePostDominatorTreePass() : ModulePass(ID) {}
+
+  bool runOnModule(Module &M) override {
+    ConfigureCache();
+    DominatorTreeCache::ComputeModule(M, true, NumOfThreads, true);
+
+    for (Function &F : M)
+      if (!F.isDeclaration())
+        CheckAndPrint(DominatorTreeCache::Get(F, true).get(), F, true);
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DominatorTreeCache::Clear();
     return false;
   }
 };
@@ -24,4 +267,18 @@ struct OurDominatorTreePass : public FunctionPass {
 
 char OurDominatorTreePass::ID = 0;
 static RegisterPass<OurDominatorTreePass> X("print-our-dominator-tree",
-                                            "Our dominator tree pass");
\ No newline at end of file
+                                            "Our dominator tree pass");
+
+char OurPostDominatorTreePass::ID = 0;
+static RegisterPass<OurPostDominatorTreePass> Y("print-our-post-dominator-tree",
+                                                "Our post-dominator tree pass");
+char OurLoopsPass::ID = 0;
+static RegisterPass<OurLoopsPass> L("print-our-loops", "Our loop nesting forest, built on our dominator tree");
+
+char OurModuleDominatorTreePass::ID = 0;
+static RegisterPass<OurModuleDominatorTreePass> Z("print-our-dominator-trees",
+                                                  "Our dominator trees for all functions, in parallel");
+
+char OurModulePostDominatorTreePass::ID = 0;
+static RegisterPass<OurModulePostDominatorTreePass> W("print-our-post-dominator-trees",
+                                                      "Our post-dominator trees for all functions, in parallel");
@@ -0,0 +1,281 @@
+#include "LoopNestingForest.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/DepthFirstSearch.h"
+#include "llvm/IR/CFG.h"
+
+#include <algorithm>
+
+OurLoop::OurLoop(BasicBlock *Header, OurLoop *ParentLoop)
+  : Header(Header), ParentLoop(ParentLoop)
+{
+  Depth = ParentLoop ? ParentLoop->Depth + 1 : 1;
+  Reducible = true;
+  Blocks.push_back(Header);
+  BlockSet.insert(Header);
+}
+
+BasicBlock* OurLoop::GetExitBlock() const
+{
+  return ExitBlocks.size() == 1 ? ExitBlocks.front() : nullptr;
+}
+
+BasicBlock* OurLoop::GetPreheader() const
+{
+  BasicBlock* Preheader = nullptr;
+
+  for (BasicBlock* Predecessor : predecessors(Header)) {
+    if (Contains(Predecessor))
+      continue;
+    if (Preheader && Preheader != Predecessor)
+      return nullptr;
+    Preheader = Predecessor;
+  }
+
+  if (!Preheader || Preheader->getTerminator()->getNumSuccessors() != 1)
+    return nullptr;
+  return Preheader;
+}
+
+LoopNestingForest::LoopNestingForest(Function &F, DominatorTree &DomTree)
+{
+  Build(F, DomTree);
+}
+
+// Predstavnik skupa u union-find strukturi, sa sabijanjem putanje
+static int Find(std::vector<int> &UnionFind, int Node)
+{
+  int Root = Node;
+  while (UnionFind[Root] != Root)
+    Root = UnionFind[Root];
+
+  while (UnionFind[Node] != Root) {
+    int Next = UnionFind[Node];
+    UnionFind[Node] = Root;
+    Node = Next;
+  }
+
+  return Root;
+}
+
+void LoopNestingForest::Build(Function &F, DominatorTree &DomTree)
+{
+  std::shared_ptr<const DenseCFG> Graph = DenseCFG::Get(F);
+  unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+  if (NumOfBlocks == 0)
+    return;
+
+  // DFS preorder: Number[i] je redni broj bloka i, Order[k] blok sa rednim brojem k, a Last[k]
+  // najveci redni broj u DFS podstablu od k. Dalje se sve radi nad rednim brojevima.
+  std::vector<int> Number(NumOfBlocks, -1);
+  std::vector<unsigned> Order;
+  std::vector<int> Last;
+
+  DepthFirstSearch(
+      0u,
+      [&Graph](unsigned Node) {
+        return Graph->GetSuccessors(Node);
+      },
+      [&Number, &Order, &Last](unsigned Node, unsigned) {
+        if (Number[Node] != -1)
+          return false;
+
+        Number[Node] = Order.size();
+        Order.push_back(Node);
+        Last.push_back(0);
+        return true;
+      },
+      [&Number, &Order, &Last](unsigned Node) {
+        Last[Number[Node]] = Order.size() - 1;
+      });
+
+  int NumOfReachable = Order.size();
+  auto IsAncestor = [&Last](int A, int B) {
+    return A <= B && B <= Last[A];
+  };
+
+  // Grane ka w iz njegovih DFS potomaka su povratne, ostale (iz dostiznih blokova) nisu
+  std::vector<std::vector<int>> BackPredecessors(NumOfReachable);
+  std::vector<std::vector<int>> OtherPredecessors(NumOfReachable);
+  for (int w = 0; w < NumOfReachable; ++w) {
+    for (unsigned Predecessor : Graph->GetPredecessors(Order[w])) {
+      int v = Number[Predecessor];
+      if (v == -1)
+        continue;
+
+      if (IsAncestor(w, v))
+        BackPredecessors[w].push_back(v);
+      else
+        OtherPredecessors[w].push_back(v);
+    }
+  }
+
+  // LoopHeader[x] je zaglavlje najdublje petlje koja sadrzi x (a nije x), -1 ako je nema
+  std::vector<int> LoopHeader(NumOfReachable, -1);
+  std::vector<bool> IsHeader(NumOfReachable, false);
+  std::vector<int> UnionFind(NumOfReachable);
+  for (int w = 0; w < NumOfReachable; ++w)
+    UnionFind[w] = w;
+
+  std::vector<bool> InBody(NumOfReachable, false);
+  std::vector<int> Body;
+  std::vector<int> Worklist;
+
+  for (int w = NumOfReachable - 1; w >= 0; --w) {
+    Body.clear();
+
+    for (int v : BackPredecessors[w]) {
+      if (v == w) {
+        IsHeader[w] = true;
+        continue;
+      }
+
+      int Representative = Find(UnionFind, v);
+      if (!InBody[Representative]) {
+        InBody[Representative] = true;
+        Body.push_back(Representative);
+      }
+    }
+
+    if (!Body.empty())
+      IsHeader[w] = true;
+
+    // Telo se siri unazad kroz grane koje nisu povratne. Prethodnik van DFS podstabla od w ulazi
+    // u petlju mimo w; on se dodaje kao prethodnik od w, da bi ga videla spoljasnja petlja.
+    Worklist = Body;
+    while (!Worklist.empty()) {
+      int x = Worklist.back();
+      Worklist.pop_back();
+
+      for (int y : OtherPredecessors[x]) {
+        int Representative = Find(UnionFind, y);
+
+        if (!IsAncestor(w, Representative)) {
+          OtherPredecessors[w].push_back(Representative);
+          continue;
+        }
+
+        if (Representative != w && !InBody[Representative]) {
+          InBody[Representative] = true;
+          Body.push_back(Representative);
+          Worklist.push_back(Representative);
+        }
+      }
+    }
+
+    for (int x : Body) {
+      LoopHeader[x] = w;
+      UnionFind[x] = w;
+      InBody[x] = false;
+    }
+  }
+
+  // Petlje se prave u preorder-u, pa je spoljasnja petlja uvek napravljena pre unutrasnje
+  std::vector<OurLoop*> LoopOf(NumOfReachable, nullptr);
+  for (int w = 0; w < NumOfReachable; ++w) {
+    if (!IsHeader[w])
+      continue;
+
+    OurLoop* Parent = LoopHeader[w] == -1 ? nullptr : LoopOf[LoopHeader[w]];
+    Loops.push_back(std::make_unique<OurLoop>(Graph->GetBlock(Order[w]), Parent));
+    LoopOf[w] = Loops.back().get();
+
+    if (Parent)
+      Parent->SubLoops.push_back(LoopOf[w]);
+    else
+      TopLevelLoops.push_back(LoopOf[w]);
+  }
+
+  // Blokovi se dodaju svojoj najdubljoj petlji i svim spoljasnjim, redom kojim su u funkciji
+  for (unsigned i = 0; i < NumOfBlocks; ++i) {
+    int x = Number[i];
+    if (x == -1)
+      continue;
+
+    OurLoop* Innermost = IsHeader[x] ? LoopOf[x] : (LoopHeader[x] == -1 ? nullptr : LoopOf[LoopHeader[x]]);
+    if (!Innermost)
+      continue;
+
+    BasicBlock* BB = Graph->GetBlock(i);
+    InnermostLoop[BB] = Innermost;
+    for (OurLoop* L = Innermost; L; L = L->ParentLoop) {
+      if (L->Header == BB)
+        continue;
+      L->Blocks.push_back(BB);
+      L->BlockSet.insert(BB);
+    }
+  }
+
+  for (auto &L : Loops) {
+    for (BasicBlock* BB : L->Blocks) {
+      // Svodljiva petlja: zaglavlje dominira svim blokovima, pa su sve grane ka njemu povratne
+      // u smislu dominatora, a ne samo DFS-a
+      if (!DomTree.Dominates(L->Header, BB))
+        L->Reducible = false;
+
+      bool Exiting = false;
+      for (BasicBlock* Successor : successors(BB)) {
+        if (Successor == L->Header && std::find(L->Latches.begin(), L->Latches.end(), BB) == L->Latches.end())
+          L->Latches.push_back(BB);
+
+        if (L->Contains(Successor))
+          continue;
+
+        Exiting = true;
+        if (std::find(L->ExitBlocks.begin(), L->ExitBlocks.end(), Successor) == L->ExitBlocks.end())
+          L->ExitBlocks.push_back(Successor);
+      }
+
+      if (Exiting)
+        L->ExitingBlocks.push_back(BB);
+    }
+  }
+}
+
+std::vector<OurLoop*> LoopNestingForest::GetLoopsInnermostFirst() const
+{
+  // Loops su u preorder-u sume, pa je obrnut redosled uvek unutrasnja petlja pre spoljasnje
+  std::vector<OurLoop*> Result;
+  for (auto It = Loops.rbegin(); It != Loops.rend(); ++It)
+    Result.push_back(It->get());
+  return Result;
+}
+
+OurLoop* LoopNestingForest::GetLoopFor(BasicBlock *BB) const
+{
+  auto It = InnermostLoop.find(BB);
+  return It == InnermostLoop.end() ? nullptr : It->second;
+}
+
+unsigned LoopNestingForest::GetLoopDepth(BasicBlock *BB) const
+{
+  OurLoop* L = GetLoopFor(BB);
+  return L ? L->GetDepth() : 0;
+}
+
+static void PrintBlocks(raw_ostream &Out, const char *Title, const std::vector<BasicBlock*> &Blocks)
+{
+  Out << Title << ":";
+  for (BasicBlock* BB : Blocks) {
+    Out << " ";
+    BB->printAsOperand(Out, false);
+  }
+  Out << "\n";
+}
+
+void LoopNestingForest::Print(raw_ostream &Out) const
+{
+  for (auto &L : Loops) {
+    std::string Indent(2 * L->Depth, ' ');
+
+    Out << Indent << "Loop at depth " << L->Depth << " with header ";
+    L->Header->printAsOperand(Out, false);
+    Out << (L->Reducible ? "" : " (irreducible)") << "\n";
+
+    Out << Indent << "  ";
+    PrintBlocks(Out, "blocks", L->Blocks);
+    Out << Indent << "  ";
+    PrintBlocks(Out, "latches", L->Latches);
+    Out << Indent << "  ";
+    PrintBlocks(Out, "exits", L->ExitBlocks);
+  }
+}
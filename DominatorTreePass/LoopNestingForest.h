@@ -0,0 +1,85 @@
+#ifndef LLVM_PROJECT_LOOPNESTINGFOREST_H
+#define LLVM_PROJECT_LOOPNESTINGFOREST_H
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
+#include "DominatorTree.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace llvm;
+
+// Petlja u sumi petlji. Blokovi su zaglavlje pa ostali blokovi petlje (i podpetlji) redom kojim su
+// u funkciji. Svodljiva petlja ima jedan ulaz, zaglavlje, koje dominira svim njenim blokovima; kod
+// nesvodljive se u telo ulazi i mimo zaglavlja, a zaglavlje je prvi blok petlje u DFS-u.
+class OurLoop {
+private:
+  BasicBlock* Header;
+  OurLoop* ParentLoop;
+  std::vector<OurLoop*> SubLoops;
+  std::vector<BasicBlock*> Blocks;
+  std::unordered_set<BasicBlock*> BlockSet;
+  // Blokovi petlje sa granom ka zaglavlju
+  std::vector<BasicBlock*> Latches;
+  // Blokovi petlje sa granom van petlje i blokovi van petlje u koje te grane vode, bez ponavljanja
+  std::vector<BasicBlock*> ExitingBlocks;
+  std::vector<BasicBlock*> ExitBlocks;
+  unsigned Depth;
+  bool Reducible;
+
+  friend class LoopNestingForest;
+public:
+  OurLoop(BasicBlock* Header, OurLoop* ParentLoop);
+
+  BasicBlock* GetHeader() const { return Header; }
+  OurLoop* GetParentLoop() const { return ParentLoop; }
+  const std::vector<OurLoop*>& GetSubLoops() const { return SubLoops; }
+  const std::vector<BasicBlock*>& GetBlocks() const { return Blocks; }
+  const std::vector<BasicBlock*>& GetLatches() const { return Latches; }
+  const std::vector<BasicBlock*>& GetExitingBlocks() const { return ExitingBlocks; }
+  const std::vector<BasicBlock*>& GetExitBlocks() const { return ExitBlocks; }
+  unsigned GetDepth() const { return Depth; }
+  bool IsReducible() const { return Reducible; }
+  bool Contains(BasicBlock* BB) const { return BlockSet.find(BB) != BlockSet.end(); }
+
+  // Jedini izlazni blok, ili nullptr ako ih ima vise ili nijedan
+  BasicBlock* GetExitBlock() const;
+  // Jedini prethodnik zaglavlja van petlje, ako mu je zaglavlje jedini naslednik, inace nullptr
+  BasicBlock* GetPreheader() const;
+};
+
+// Suma petlji funkcije (loop nesting forest) po Havlak-ovom algoritmu, sa Ramalingam-ovom ispravkom.
+// Blokovi se obilaze u obrnutom DFS preorder-u; za svaki blok w telo petlje su blokovi iz kojih se
+// unazad, kroz grane koje nisu povratne, stize do izvora povratnih grana ka w. Vec pronadjene
+// unutrasnje petlje su sazete union-find strukturom u svoje zaglavlje, pa je ukupno vreme skoro
+// linearno. Ako se pri tome stigne do bloka koji nije potomak w u DFS stablu, u petlju se ulazi i
+// mimo w, pa je ona nesvodljiva.
+//
+// Stablo dominatora (ne postdominatora) iste funkcije odredjuje koje su petlje svodljive.
+class LoopNestingForest {
+private:
+  std::vector<std::unique_ptr<OurLoop>> Loops;
+  std::vector<OurLoop*> TopLevelLoops;
+  std::unordered_map<BasicBlock*, OurLoop*> InnermostLoop;
+
+  void Build(Function&, DominatorTree&);
+public:
+  LoopNestingForest(Function&, DominatorTree&);
+
+  const std::vector<OurLoop*>& GetTopLevelLoops() const { return TopLevelLoops; }
+  // Sve petlje, unutrasnje pre spoljasnjih (kao sto ih obradjuje LoopPass)
+  std::vector<OurLoop*> GetLoopsInnermostFirst() const;
+
+  // Najdublja petlja koja sadrzi blok, ili nullptr
+  OurLoop* GetLoopFor(BasicBlock*) const;
+  // 0 za blokove van petlji
+  unsigned GetLoopDepth(BasicBlock*) const;
+
+  void Print(raw_ostream&) const;
+};
+
+#endif // LLVM_PROJECT_LOOPNESTINGFOREST_H
@@ -0,0 +1,371 @@
+#include "dominator_tree.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "../Graph/DepthFirstSearch.h"
+
+const char* algorithm_name(algorithm kind)
+{
+  switch (kind) {
+    case algorithm::naive:
+      return "naive";
+    case algorithm::lengauer_tarjan:
+      return "lengauer-tarjan";
+    case algorithm::semi_nca:
+      return "semi-nca";
+    case algorithm::iterative:
+      return "iterative";
+    case algorithm::automatic:
+      return "automatic";
+  }
+  return "unknown";
+}
+
+algorithm choose_algorithm(const Graph& graph)
+{
+  return graph.get_num_of_vertices() <= iterative_vertex_limit ? algorithm::iterative : algorithm::semi_nca;
+}
+
+DominatorTree::DominatorTree(const Graph& graph) : graph(graph)
+{
+  num_of_vertices = graph.get_num_of_vertices();
+}
+
+// Preorder, postorder i roditelji se preuzimaju iz DFSOrder-a, a ulazna numeracija je preorder broj + 1
+void DominatorTree::DFS(int start_node)
+{
+  DFSOrder<int> order(num_of_vertices);
+  order.Run(start_node, [this](int node) { return graph.successors(node); });
+
+  visited_order = std::move(order.Preorder);
+  finished_order = std::move(order.Postorder);
+  parents = std::move(order.Parent);
+  for (int node : visited_order) {
+    visited[node] = true;
+    in_numeration[node] = order.PreorderNumber[node] + 1;
+  }
+}
+
+void DominatorTree::find_semi_dominator_candidates(int start_node, std::vector<int>& candidates)
+{
+  // Krecemo se obrnutom putanjom od cvora za kog trazimo semidominatora i razmatramo sve prethodno neposecene cvorove.
+  // Ukoliko je ulazna numeracija cvora koji je potencijalni kandidat manja u odnosu na numeraciju tog cvora, dodajemo
+  // ga u vektor kandidata i dalje od njega ne idemo. Nedostizni cvorovi nisu na putanji iz pocetnog cvora.
+  DepthFirstSearch(
+      start_node,
+      [this](int node) { return graph.predecessors(node); },
+      [this, start_node, &candidates](int node, int) {
+        if (visited[node] || in_numeration[node] == 0)
+          return false;
+        visited[node] = true;
+
+        if (in_numeration[start_node] > in_numeration[node]) {
+          candidates.push_back(node);
+          return false;
+        }
+        return true;
+      },
+      [](int) {});
+}
+
+int DominatorTree::find_semi_dominator(int node)
+{
+  std::vector<int> candidates;
+  // Posecene cvorove opet postavljamo na false, kako bismo ponavljali postupak trazenja kandidata za semidominatore.
+  std::fill(visited.begin(), visited.end(), false);
+
+  find_semi_dominator_candidates(node, candidates);
+
+  int min_numeration = std::numeric_limits<int>::max();
+  int semi_dominator = node;
+
+  // Od svih kandidata, semidominator je onaj cvor koji ima NAJMANJU ULAZNU NUMERACIJU.
+  for (int candidate : candidates) {
+    if (in_numeration[candidate] < min_numeration) {
+      min_numeration = in_numeration[candidate];
+      semi_dominator = candidate;
+    }
+  }
+
+  return semi_dominator;
+}
+
+void DominatorTree::find_semi_dominators()
+{
+  // Semidominatore trazimo za cvorove u OBRNUTOM poretku od onog u kom smo ih obilazili prilikom DFS pretrage.
+  // Pocetni cvor nema semidominatora, pa njega ignorisemo.
+  for (auto it = visited_order.rbegin(); it + 1 != visited_order.rend(); ++it)
+    sdom[*it] = find_semi_dominator(*it);
+}
+
+void DominatorTree::find_immediate_dominators()
+{
+  // Za svaki cvor gledamo putanju od njega do njegovog semidominatora i trazimo cvor sa najmanjim semidominatorom
+  // (po ulaznoj numeraciji). Ako je to sam cvor, idom je semidominator, a inace je idom jednak idom-u tog cvora.
+  for (int node : visited_order) {
+    int min_node = node;
+
+    for (int u = node; in_numeration[u] > in_numeration[sdom[node]]; u = parents[u]) {
+      if (in_numeration[sdom[u]] < in_numeration[sdom[min_node]])
+        min_node = u;
+    }
+
+    ancestors[node] = min_node == node ? -1 : min_node;
+  }
+
+  // Preci su blizi pocetnom cvoru, pa su u ulaznom poretku vec obradjeni
+  for (int node : visited_order) {
+    if (ancestors[node] == -1)           // sdom[node] je idom
+      idom[node] = sdom[node];
+    else
+      idom[node] = idom[ancestors[node]];
+  }
+}
+
+// Kompresija putanje od v do korena njegovog stabla u sumi, bez rekurzije: prvo se skupi putanja, pa se obradjuje
+// od cvora najblizeg korenu, kao sto bi to radila rekurzivna verzija.
+void DominatorTree::compress(int v)
+{
+  path.clear();
+  for (int u = v; ancestors[ancestors[u]] != 0; u = ancestors[u])
+    path.push_back(u);
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    int u = *it;
+    int ancestor = ancestors[u];
+
+    if (semi[label[ancestor]] < semi[label[u]])
+      label[u] = label[ancestor];
+    ancestors[u] = ancestors[ancestor];
+  }
+}
+
+int DominatorTree::eval(int v)
+{
+  if (ancestors[v] == 0)
+    return v;
+
+  compress(v);
+  return label[v];
+}
+
+// Semidominatori u obrnutom ulaznom poretku: za svakog prethodnika v cvora w, eval(v) je cvor sa najmanjim semi na
+// putanji od v do vec obradjenog pretka, pa je semi[w] najmanji od njih. Posle toga se w linkuje za roditelja.
+void DominatorTree::find_semi_dominators_with_forest(bool fill_buckets)
+{
+  int count = visited_order.size();
+
+  for (int w = count; w >= 2; --w) {
+    for (int predecessor : graph.predecessors(visited_order[w - 1])) {
+      int v = in_numeration[predecessor];
+      if (v == 0)
+        continue;
+
+      int u = eval(v);
+      if (semi[u] < semi[w])
+        semi[w] = semi[u];
+    }
+
+    int parent = parent_number[w];
+    ancestors[w] = parent;
+
+    if (!fill_buckets)
+      continue;
+
+    bucket_next[w] = bucket_head[semi[w]];
+    bucket_head[semi[w]] = w;
+
+    // Za cvorove ciji je semidominator roditelj od w: ako na putanji od roditelja do njih postoji cvor sa manjim
+    // semidominatorom, idom je isti kao njegov (to se razresava posle), a inace je idom bas roditelj.
+    for (int v = bucket_head[parent]; v != 0; v = bucket_next[v]) {
+      int u = eval(v);
+      dom[v] = semi[u] < semi[v] ? u : parent;
+    }
+    bucket_head[parent] = 0;
+  }
+}
+
+void DominatorTree::lengauer_tarjan()
+{
+  find_semi_dominators_with_forest(true);
+
+  int count = visited_order.size();
+  for (int w = 2; w <= count; ++w) {
+    if (dom[w] != semi[w])
+      dom[w] = dom[dom[w]];
+  }
+}
+
+// idom je najblizi zajednicki predak roditelja i semidominatora u vec izgradjenom delu stabla dominatora: penjemo
+// se od roditelja po idom-ovima dok ne dodjemo do cvora sa numeracijom najvise semi[w].
+void DominatorTree::semi_nca()
+{
+  find_semi_dominators_with_forest(false);
+
+  int count = visited_order.size();
+  for (int w = 2; w <= count; ++w) {
+    dom[w] = parent_number[w];
+    while (dom[w] > semi[w])
+      dom[w] = dom[dom[w]];
+  }
+}
+
+// Dva cvora (po RPO broju) se penju ka korenu u trenutnom stablu dok se ne sretnu. Cvor sa vecim RPO
+// brojem ne moze biti predak onog sa manjim, pa se uvek penje on.
+int DominatorTree::intersect(int a, int b)
+{
+  while (a != b) {
+    while (a > b)
+      a = dom[a];
+    while (b > a)
+      b = dom[b];
+  }
+  return a;
+}
+
+// Cooper-Harvey-Kennedy: idom svakog cvora je presek obradjenih prethodnika, a prolazi po RPO-u se
+// ponavljaju dok se nesto menja. Za svodljive grafove su dovoljna dva prolaza. dom je ovde indeksiran
+// RPO brojem, a -1 znaci da idom jos nije poznat.
+void DominatorTree::iterative()
+{
+  int count = finished_order.size();
+  rpo_number.assign(num_of_vertices, -1);
+  for (int r = 0; r < count; ++r)
+    rpo_number[finished_order[count - 1 - r]] = r;
+
+  dom.assign(count, -1);
+  dom[0] = 0;
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    for (int r = 1; r < count; ++r) {
+      int new_idom = -1;
+
+      for (int predecessor : graph.predecessors(finished_order[count - 1 - r])) {
+        int p = rpo_number[predecessor];
+        if (p == -1 || dom[p] == -1)
+          continue;
+
+        new_idom = new_idom == -1 ? p : intersect(p, new_idom);
+      }
+
+      if (dom[r] != new_idom) {
+        dom[r] = new_idom;
+        changed = true;
+      }
+    }
+  }
+
+  for (int r = 1; r < count; ++r)
+    idom[finished_order[count - 1 - r]] = finished_order[count - 1 - dom[r]];
+}
+
+void DominatorTree::store_immediate_dominators()
+{
+  int count = visited_order.size();
+
+  for (int w = 2; w <= count; ++w) {
+    int node = visited_order[w - 1];
+    idom[node] = visited_order[dom[w] - 1];
+    sdom[node] = visited_order[semi[w] - 1];
+  }
+}
+
+void DominatorTree::run(algorithm kind)
+{
+  if (kind == algorithm::automatic)
+    kind = choose_algorithm(graph);
+
+  visited_order.clear();
+  finished_order.clear();
+  visited.assign(num_of_vertices, false);
+  in_numeration.assign(num_of_vertices, 0);
+  parents.assign(num_of_vertices, -1);
+  ancestors.assign(num_of_vertices, -1);
+  idom.assign(num_of_vertices, -1);
+  sdom.resize(num_of_vertices);
+  for (int i = 0; i < num_of_vertices; ++i)
+    sdom[i] = i;
+
+  if (num_of_vertices == 0)
+    return;
+
+  DFS(0);
+  idom[0] = 0;
+
+  if (kind == algorithm::naive) {
+    find_semi_dominators();
+    find_immediate_dominators();
+    return;
+  }
+
+  if (kind == algorithm::iterative) {
+    iterative();
+    return;
+  }
+
+  // Nizovi po ulaznoj numeraciji 1..count, a 0 oznacava koren stabla u sumi
+  int count = visited_order.size();
+  parent_number.assign(count + 1, 0);
+  semi.resize(count + 1);
+  label.resize(count + 1);
+  ancestors.assign(count + 1, 0);
+  dom.assign(count + 1, 0);
+  dom[1] = 1;
+  for (int w = 1; w <= count; ++w) {
+    semi[w] = label[w] = w;
+    if (w > 1)
+      parent_number[w] = in_numeration[parents[visited_order[w - 1]]];
+  }
+
+  if (kind == algorithm::lengauer_tarjan) {
+    bucket_head.assign(count + 1, 0);
+    bucket_next.assign(count + 1, 0);
+    lengauer_tarjan();
+  } else {
+    semi_nca();
+  }
+
+  store_immediate_dominators();
+}
+
+size_t DominatorTree::memory_usage() const
+{
+  size_t bytes = visited.capacity() / 8;
+
+  for (const std::vector<int>* v : {&visited_order, &finished_order, &in_numeration, &sdom, &parents, &ancestors,
+                                    &idom, &parent_number, &semi, &label, &bucket_head, &bucket_next, &dom, &path,
+                                    &rpo_number})
+    bytes += v->capacity() * sizeof(int);
+
+  return bytes;
+}
+
+void DominatorTree::print_tree(std::string file_name, bool dominator_tree, GraphFormat format)
+{
+  GraphExporter exporter({format, false}, file_name + " for 'main' function", {"#072757", "#2462bf"});
+  std::string error;
+
+  if (!exporter.Open(file_name + GetGraphFileExtension(format), error)) {
+    std::cerr << error << "\n";
+    return;
+  }
+
+  for (int i = 0; i < num_of_vertices; ++i) {
+    exporter.AddNode(i, std::to_string(i));
+    if (i == 0 || idom[i] == -1)
+      continue;
+
+    if (dominator_tree)
+      exporter.AddEdge(idom[i], i);
+    else if (sdom[i] != i)              // iterativni algoritam ne racuna semidominatore
+      exporter.AddEdge(sdom[i], i);
+  }
+
+  if (!exporter.Close(error))
+    std::cerr << error << "\n";
+}
@@ -0,0 +1,105 @@
+#ifndef DOMINATORS_DOMINATOR_TREE_H
+#define DOMINATORS_DOMINATOR_TREE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "../Graph/GraphExporter.h"
+
+// Algoritmi za racunanje stabla dominatora:
+//  naive           - semidominator po definiciji, obilaskom unazad za svaki cvor, O(V * E)
+//  lengauer_tarjan - Lengauer-Tarjan sa kompresijom putanja, O(E log V)
+//  semi_nca        - semidominatori kao kod Lengauer-Tarjan-a, a idom kao najblizi zajednicki
+//                    predak roditelja i semidominatora, O(V^2) u najgorem slucaju, ali brz u praksi
+//  iterative       - Cooper-Harvey-Kennedy: iterativni dataflow nad RPO-om, gde je presek dva skupa
+//                    dominatora najblizi zajednicki predak u trenutnom stablu. Nema semidominatora.
+//  automatic       - iterative za grafove do iterative_vertex_limit cvorova, a semi_nca za vece
+enum class algorithm { naive, lengauer_tarjan, semi_nca, iterative, automatic };
+
+// Granica izmerena ovim alatom (random, ladder i irreducible grafovi sa 2 grane po cvoru): do oko 64
+// cvora je iterativni algoritam jednako brz ili brzi, jer nema forest-a ni semidominatora, a vec na
+// 128 cvorova ga Semi-NCA prestize. Na velikim nesvodljivim grafovima iterativni je kvadratni.
+// Ista granica se koristi u DominatorTreePass-u.
+const int iterative_vertex_limit = 64;
+
+const char* algorithm_name(algorithm);
+algorithm choose_algorithm(const Graph& graph);
+
+class DominatorTree
+{
+private:
+  const Graph& graph;
+  int num_of_vertices;
+
+  // Redosled obilaska cvorova u toku DFS pretrage.
+  std::vector<int> visited_order;
+
+  // Izlazni redosled DFS pretrage, za RPO iterativnog algoritma.
+  std::vector<int> finished_order;
+
+  // Ulazna numeracija prilikom DFS pretrage, od 1. in_numeration[2] = 3 -> cvor numerisan brojem 2 ima ulaznu
+  // numeraciju 3. Nedostizni cvorovi imaju numeraciju 0.
+  std::vector<int> in_numeration;
+
+  // Marker vektor za posecene cvorove.
+  std::vector<bool> visited;
+
+  // Vektor koji pamti semidominatore za svaki cvor.
+  std::vector<int> sdom;
+
+  // Vektor roditeljskih cvorova u DFS stablu.
+  std::vector<int> parents;
+
+  // Vektor predaka. Kod naivnog algoritma to je cvor na putanji od sdom do cvora sa najmanjim sdom, a kod
+  // Lengauer-Tarjan-a predak u sumi koja se gradi linkovanjem (po ulaznoj numeraciji, 0 je koren stabla).
+  std::vector<int> ancestors;
+
+  // Vektor immediate dominatora. idom pocetnog cvora je on sam, a nedostiznih -1.
+  std::vector<int> idom;
+
+  // Stanje Lengauer-Tarjan-a i Semi-NCA, indeksirano ulaznom numeracijom: parent_number je numeracija roditelja,
+  // semi numeracija semidominatora, label cvor sa najmanjim semi na kompresovanoj putanji, a bucket lista
+  // cvorova ciji je semidominator dati cvor.
+  std::vector<int> parent_number;
+  std::vector<int> semi;
+  std::vector<int> label;
+  std::vector<int> bucket_head;
+  std::vector<int> bucket_next;
+  std::vector<int> dom;
+  std::vector<int> path;
+
+  // Redni broj cvora u RPO-u za iterativni algoritam, -1 za nedostizne
+  std::vector<int> rpo_number;
+
+  void DFS(int start_node);
+
+  void find_semi_dominator_candidates(int start_node, std::vector<int>& candidates);
+  int find_semi_dominator(int node);
+  void find_semi_dominators();
+  void find_immediate_dominators();
+
+  void compress(int v);
+  int eval(int v);
+  void find_semi_dominators_with_forest(bool fill_buckets);
+  void lengauer_tarjan();
+  void semi_nca();
+  int intersect(int a, int b);
+  void iterative();
+  void store_immediate_dominators();
+
+public:
+  DominatorTree(const Graph& graph);
+
+  void run(algorithm);
+
+  const std::vector<int>& get_immediate_dominators() const { return idom; }
+
+  // Memorija koju zauzimaju strukture algoritma (bez samog grafa), u bajtovima
+  size_t memory_usage() const;
+
+  void print_tree(std::string file_name, bool dominator_tree, GraphFormat format = GraphFormat::Dot);
+};
+
+#endif // DOMINATORS_DOMINATOR_TREE_H
@@ -0,0 +1,296 @@
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void Graph::set_arrays(const int32_t* arrays)
+{
+  successor_offsets = arrays;
+  successor_list = successor_offsets + num_of_vertices + 1;
+  predecessor_offsets = successor_list + num_of_edges;
+  predecessor_list = predecessor_offsets + num_of_vertices + 1;
+}
+
+// Brojanje grana po izvoru (odnosno odredistu) i prefiksne sume. Redosled naslednika je redosled
+// grana u edges, a prethodnici su poredjani po indeksu izvora.
+Graph::Graph(int V, const std::vector<std::pair<int, int>>& edges)
+{
+  num_of_vertices = V;
+  num_of_edges = edges.size();
+
+  storage.assign(2 * (num_of_vertices + 1 + num_of_edges), 0);
+  int32_t* successor_offsets = storage.data();
+  int32_t* successor_list = successor_offsets + num_of_vertices + 1;
+  int32_t* predecessor_offsets = successor_list + num_of_edges;
+  int32_t* predecessor_list = predecessor_offsets + num_of_vertices + 1;
+  set_arrays(storage.data());
+
+  for (auto& edge : edges) {
+    successor_offsets[edge.first + 1]++;
+    predecessor_offsets[edge.second + 1]++;
+  }
+
+  for (int i = 0; i < num_of_vertices; ++i) {
+    successor_offsets[i + 1] += successor_offsets[i];
+    predecessor_offsets[i + 1] += predecessor_offsets[i];
+  }
+
+  std::vector<int> next_successor(successor_offsets, successor_offsets + num_of_vertices);
+  for (auto& edge : edges)
+    successor_list[next_successor[edge.first]++] = edge.second;
+
+  std::vector<int> next_predecessor(predecessor_offsets, predecessor_offsets + num_of_vertices);
+  for (int u = 0; u < num_of_vertices; ++u) {
+    for (int v : successors(u))
+      predecessor_list[next_predecessor[v]++] = u;
+  }
+}
+
+bool read_edge_list(const std::string& file_name, Graph& graph, std::string& error)
+{
+  std::ifstream file(file_name);
+  if (!file) {
+    error = "cannot open '" + file_name + "'";
+    return false;
+  }
+
+  std::vector<std::pair<int, int>> edges;
+  std::string line;
+  int max_node = 0;
+  long line_number = 0;
+
+  while (std::getline(file, line)) {
+    line_number++;
+
+    const char* position = line.c_str();
+    while (*position == ' ' || *position == '\t')
+      position++;
+    if (*position == '\0' || *position == '#' || *position == '\r')
+      continue;
+
+    char* end;
+    long u = std::strtol(position, &end, 10);
+    bool valid = end != position;
+    position = end;
+    long v = std::strtol(position, &end, 10);
+    valid = valid && end != position;
+
+    if (!valid || u < 0 || v < 0 || u >= std::numeric_limits<int>::max() || v >= std::numeric_limits<int>::max()) {
+      error = file_name + ":" + std::to_string(line_number) + ": expected two non-negative node indices";
+      return false;
+    }
+
+    edges.push_back({(int)u, (int)v});
+    max_node = std::max(max_node, (int)std::max(u, v));
+  }
+
+  graph = Graph(max_node + 1, edges);
+  return true;
+}
+
+static const char binary_graph_magic[8] = {'D', 'O', 'M', 'C', 'S', 'R', '\0', '\0'};
+static const uint32_t binary_graph_version = 1;
+
+static_assert(sizeof(binary_graph_header) == 32, "binary graph header must stay 32 bytes");
+static_assert(sizeof(int) == sizeof(int32_t), "CSR arrays are read as int");
+
+bool is_binary_graph(const std::string& file_name)
+{
+  std::ifstream file(file_name, std::ios::binary);
+  char magic[sizeof(binary_graph_magic)];
+
+  return file.read(magic, sizeof(magic)) && std::memcmp(magic, binary_graph_magic, sizeof(magic)) == 0;
+}
+
+bool write_binary_graph(const std::string& file_name, const Graph& graph, std::string& error)
+{
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    error = "cannot create '" + file_name + "'";
+    return false;
+  }
+
+  binary_graph_header header = {};
+  std::memcpy(header.magic, binary_graph_magic, sizeof(header.magic));
+  header.version = binary_graph_version;
+  header.num_of_vertices = graph.get_num_of_vertices();
+  header.num_of_edges = graph.get_num_of_edges();
+
+  size_t offsets_size = (header.num_of_vertices + 1) * sizeof(int32_t);
+  size_t list_size = header.num_of_edges * sizeof(int32_t);
+
+  file.write((const char*)&header, sizeof(header));
+  file.write((const char*)graph.get_successor_offsets(), offsets_size);
+  file.write((const char*)graph.get_successor_list(), list_size);
+  file.write((const char*)graph.get_predecessor_offsets(), offsets_size);
+  file.write((const char*)graph.get_predecessor_list(), list_size);
+
+  if (!file.flush()) {
+    error = "cannot write '" + file_name + "'";
+    return false;
+  }
+  return true;
+}
+
+static bool is_valid_csr(const int32_t* offsets, const int32_t* list, uint64_t V, uint64_t E)
+{
+  if (offsets[0] != 0 || offsets[V] != (int32_t)E)
+    return false;
+
+  for (uint64_t v = 0; v < V; ++v)
+    if (offsets[v] > offsets[v + 1])
+      return false;
+
+  for (uint64_t i = 0; i < E; ++i)
+    if (list[i] < 0 || (uint64_t)list[i] >= V)
+      return false;
+
+  return true;
+}
+
+bool map_binary_graph(const std::string& file_name, Graph& graph, std::string& error)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error = "cannot open '" + file_name + "'";
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(binary_graph_header)) {
+    close(fd);
+    error = "'" + file_name + "' is too small to be a binary graph";
+    return false;
+  }
+
+  size_t size = status.st_size;
+  void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // Mapiranje ostaje vazece i posle zatvaranja fajla
+  close(fd);
+  if (address == MAP_FAILED) {
+    error = "cannot map '" + file_name + "'";
+    return false;
+  }
+
+  std::shared_ptr<void> mapping(address, [size](void* address) { munmap(address, size); });
+  auto* header = (const binary_graph_header*)address;
+
+  if (std::memcmp(header->magic, binary_graph_magic, sizeof(header->magic)) != 0 ||
+      header->version != binary_graph_version) {
+    error = "'" + file_name + "' is not a binary graph of version " + std::to_string(binary_graph_version);
+    return false;
+  }
+
+  uint64_t V = header->num_of_vertices, E = header->num_of_edges;
+  if (V >= (uint64_t)std::numeric_limits<int32_t>::max() || E >= (uint64_t)std::numeric_limits<int32_t>::max() ||
+      size != sizeof(binary_graph_header) + 2 * (V + 1 + E) * sizeof(int32_t)) {
+    error = "'" + file_name + "' has a corrupt header";
+    return false;
+  }
+
+  Graph mapped;
+  mapped.num_of_vertices = V;
+  mapped.num_of_edges = E;
+  mapped.set_arrays((const int32_t*)(header + 1));
+  mapped.mapping = std::move(mapping);
+
+  // Jedan prolaz kroz mapirane nizove, bez kopiranja: offseti rastu od 0 do E, a svaki cvor u
+  // listama je manji od V, pa kasnije indeksiranje ne moze da izadje iz nizova
+  if (!is_valid_csr(mapped.successor_offsets, mapped.successor_list, V, E) ||
+      !is_valid_csr(mapped.predecessor_offsets, mapped.predecessor_list, V, E)) {
+    error = "'" + file_name + "' has inconsistent offsets or node indices";
+    return false;
+  }
+
+  graph = std::move(mapped);
+  return true;
+}
+
+Graph generate_random_graph(int num_of_vertices, int edges_per_vertex, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<std::pair<int, int>> edges;
+  edges.reserve((size_t)num_of_vertices * std::max(edges_per_vertex, 1));
+
+  // Svaki cvor dobija granu od nekog ranijeg cvora, pa je ceo graf dostizan iz cvora 0
+  for (int v = 1; v < num_of_vertices; ++v)
+    edges.push_back({(int)(generator() % v), v});
+
+  std::uniform_int_distribution<int> node(0, num_of_vertices - 1);
+  for (long i = 0; i < (long)num_of_vertices * (edges_per_vertex - 1); ++i)
+    edges.push_back({node(generator), node(generator)});
+
+  return Graph(num_of_vertices, edges);
+}
+
+// Cvorovi 2i i 2i + 1 su jedna preca lestvice (2i -> 2i + 1). Iz obe strane se ide u levu stranu
+// sledece prece, a iz desne jos i u desnu. Skoro svaki cvor ima dva prethodnika, a idom oba cvora
+// prece je leva strana prethodne prece, pa je stablo dominatora lanac duzine V / 2.
+Graph generate_ladder_graph(int num_of_vertices)
+{
+  std::vector<std::pair<int, int>> edges;
+
+  for (int u = 0; u + 1 < num_of_vertices; u += 2) {
+    edges.push_back({u, u + 1});
+    if (u + 2 < num_of_vertices) {
+      edges.push_back({u, u + 2});
+      edges.push_back({u + 1, u + 2});
+    }
+    if (u + 3 < num_of_vertices)
+      edges.push_back({u + 1, u + 3});
+  }
+
+  return Graph(num_of_vertices, edges);
+}
+
+Graph generate_deep_chain_graph(int num_of_vertices)
+{
+  std::vector<std::pair<int, int>> edges;
+
+  for (int u = 0; u + 1 < num_of_vertices; ++u)
+    edges.push_back({u, u + 1});
+  if (num_of_vertices > 1)
+    edges.push_back({num_of_vertices - 1, 0});
+
+  return Graph(num_of_vertices, edges);
+}
+
+// Grupe od tri cvora h, a, b: h -> a, h -> b, a <-> b je petlja sa dva ulaza (nesvodljiva), a iz
+// a i b se ide u sledecu grupu. Povratna grana iz b u slucajnu raniju grupu pravi nesvodljive
+// petlje koje obuhvataju vise grupa.
+Graph generate_irreducible_graph(int num_of_vertices, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<std::pair<int, int>> edges;
+
+  for (int h = 0; h < num_of_vertices; h += 3) {
+    int a = h + 1, b = h + 2, next = h + 3;
+
+    if (a < num_of_vertices)
+      edges.push_back({h, a});
+    if (b < num_of_vertices) {
+      edges.push_back({h, b});
+      edges.push_back({a, b});
+      edges.push_back({b, a});
+    }
+    if (next < num_of_vertices) {
+      edges.push_back({a, next});
+      edges.push_back({b, next});
+    }
+    if (b < num_of_vertices && h > 0) {
+      int group = generator() % (h / 3);
+      edges.push_back({b, 3 * group + 1 + (int)(generator() % 2)});
+    }
+  }
+
+  return Graph(num_of_vertices, edges);
+}
@@ -0,0 +1,110 @@
+#ifndef DOMINATORS_GRAPH_H
+#define DOMINATORS_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Opseg suseda jednog cvora u CSR nizu, da bi moglo da se pise for (int v : graph.successors(u)).
+struct node_range
+{
+  const int* first;
+  const int* last;
+
+  const int* begin() const { return first; }
+  const int* end() const { return last; }
+  int size() const { return last - first; }
+};
+
+// Usmereni graf sa cvorovima 0..num_of_vertices-1 u CSR obliku; pocetni cvor je uvek 0.
+// Naslednici cvora u su successor_list[successor_offsets[u] .. successor_offsets[u + 1]), isto i za
+// prethodnike. Za velike grafove (milioni cvorova) to su cetiri niza umesto vektora po cvoru.
+//
+// Nizovi su samo pogledi: pokazuju ili u storage (graf napravljen iz liste grana) ili direktno u
+// mmap-ovan binarni fajl (map_binary_graph), pa se pri ucitavanju nista ne kopira. Zato se graf
+// moze samo premestati, ne i kopirati.
+class Graph
+{
+private:
+  int num_of_vertices = 0;
+  long num_of_edges = 0;
+  const int32_t* successor_offsets = nullptr;
+  const int32_t* successor_list = nullptr;
+  const int32_t* predecessor_offsets = nullptr;
+  const int32_t* predecessor_list = nullptr;
+
+  // Sva cetiri niza jedan za drugim, istim redom kao u binarnom fajlu
+  std::vector<int32_t> storage;
+  // Mapiranje fajla, oslobadja se (munmap) kada se unisti poslednji graf koji ga koristi
+  std::shared_ptr<void> mapping;
+
+  void set_arrays(const int32_t* arrays);
+
+  friend bool map_binary_graph(const std::string& file_name, Graph& graph, std::string& error);
+
+public:
+  Graph() = default;
+  Graph(int V, const std::vector<std::pair<int, int>>& edges);
+
+  Graph(const Graph&) = delete;
+  Graph& operator=(const Graph&) = delete;
+  Graph(Graph&&) = default;
+  Graph& operator=(Graph&&) = default;
+
+  int get_num_of_vertices() const { return num_of_vertices; }
+  long get_num_of_edges() const { return num_of_edges; }
+
+  node_range successors(int node) const
+  {
+    return {successor_list + successor_offsets[node], successor_list + successor_offsets[node + 1]};
+  }
+
+  node_range predecessors(int node) const
+  {
+    return {predecessor_list + predecessor_offsets[node], predecessor_list + predecessor_offsets[node + 1]};
+  }
+
+  const int32_t* get_successor_offsets() const { return successor_offsets; }
+  const int32_t* get_successor_list() const { return successor_list; }
+  const int32_t* get_predecessor_offsets() const { return predecessor_offsets; }
+  const int32_t* get_predecessor_list() const { return predecessor_list; }
+};
+
+// Tekstualna lista grana: u svakom redu "u v" za granu u -> v, prazni redovi i redovi koji pocinju
+// sa '#' se preskacu. Broj cvorova je najveci indeks + 1. U slucaju greske vraca false i opis u error.
+bool read_edge_list(const std::string& file_name, Graph& graph, std::string& error);
+
+// Binarni CSR format, u redosledu bajtova masine na kojoj je napravljen:
+//   binary_graph_header (32 bajta)
+//   int32 successor_offsets[V + 1], int32 successor_list[E]
+//   int32 predecessor_offsets[V + 1], int32 predecessor_list[E]
+// Prethodnici su u fajlu da se ne bi racunali pri ucitavanju. Fajl se ucitava sa mmap, bez
+// kopiranja nizova. Pored zaglavlja i velicine fajla, map_binary_graph jednim prolazom kroz
+// mapirane nizove proverava offsete i indekse cvorova, pa je ucitavanje O(V + E).
+struct binary_graph_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t num_of_vertices;
+  uint64_t num_of_edges;
+};
+
+// Da li fajl pocinje zaglavljem binarnog formata
+bool is_binary_graph(const std::string& file_name);
+bool write_binary_graph(const std::string& file_name, const Graph& graph, std::string& error);
+bool map_binary_graph(const std::string& file_name, Graph& graph, std::string& error);
+
+// Generatori grafova za merenje. Svi cvorovi su dostizni iz cvora 0.
+//  random      - slucajno DFS stablo i jos (edges_per_vertex - 1) * V slucajnih grana
+//  ladder      - dva lanca spojena precama, duboko stablo dominatora sa mnogo grana
+//  deep-chain  - jedan lanac duzine V sa povratnom granom, najdublje moguce stablo
+//  irreducible - niz petlji sa dva ulaza, povezanih slucajnim povratnim granama
+Graph generate_random_graph(int num_of_vertices, int edges_per_vertex, unsigned seed);
+Graph generate_ladder_graph(int num_of_vertices);
+Graph generate_deep_chain_graph(int num_of_vertices);
+Graph generate_irreducible_graph(int num_of_vertices, unsigned seed);
+
+#endif // DOMINATORS_GRAPH_H
@@ -1,217 +1,282 @@
-#include <iostream>
-#include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
 #include <limits>
-#include <fstream>
-
-class DominatorTree
-{
-private:
-  int num_of_vertices;
-
-  // Lista povezanosti za graf. Ako postoji grana od cvora u ka proizvoljnom cvoru v, cuvamo {u: {v}}
-  std::vector<std::vector<int>> adjacency_list;
-
-  // Cuvamo grane obrnutog usmerenja od onog koje postoji u grafu. Ako smo imali granu 2 -> 3, ovde cuvamo 3 -> 2. Potrebno
-  // nam je na dalje za proveru svih putanja u nazad.
-  std::vector<std::vector<int>> reversed_adjacency_list;
-
-  // Redosled obilaska cvorova u toku DFS pretrage.
-  std::vector<int> visited_order;
-
-  // Ulazna numeracija prilikom DFS pretrage. in_numeration[2] = 3 -> cvor numerisan brojem 2 ima ulaznu numeraciju 3.
-  std::vector<int> in_numeration;
+#include <string>
+#include <vector>
 
-  // Marker vektor za posecene cvorove.
-  std::vector<bool> visited;
+#include <sys/resource.h>
 
-  // Vektor koji pamti semidominatore za svaki cvor.
-  std::vector<int> sdom;
+#include "dominator_tree.h"
+#include "graph.h"
 
-  // Vektor roditeljskih cvorova.
-  std::vector<int> parents;
+// Alat za merenje algoritama za stablo dominatora bez LLVM-a: graf se cita iz liste grana ili binarnog CSR fajla
+// ili se generise, svaki algoritam se pokrece vise puta, a ispisuje se najbolje i prosecno vreme, broj cvorova u
+// sekundi i memorija. --convert upisuje ucitani ili generisani graf u binarni format.
+// Bez argumenata radi kao ranije: racuna stablo za mali primer i pravi semidominators.dot i dominator_tree.dot.
 
-  // Vektor predaka
-  std::vector<int> ancestors;
+struct options
+{
+  std::string input_file;
+  std::string convert_file;
+  std::string generator;
+  int num_of_vertices = 1000000;
+  int edges_per_vertex = 4;
+  unsigned seed = 1;
+  std::vector<algorithm> algorithms;
+  int repeat = 3;
+  // Naivni algoritam je kvadratni, pa se za vece grafove preskace ako nije eksplicitno trazen
+  int naive_limit = 20000;
+  bool verify = false;
+  bool print = false;
+  bool dot = false;
+  GraphFormat dot_format = GraphFormat::Dot;
+};
 
-  // Vektor immediate dominatora.
-  std::vector<int> idom;
+static void print_usage(const char* program)
+{
+  std::cerr << "usage: " << program << " [options]\n"
+            << "  --input FILE          read the graph from a text edge list (\"u v\" per line, node 0 is the entry)\n"
+            << "                        or map it from a binary CSR file\n"
+            << "  --convert FILE        write the graph as a binary CSR file and exit\n"
+            << "  --generate KIND       generate a graph: random, ladder, deep-chain, irreducible, example\n"
+            << "  --vertices N          number of vertices for generated graphs (default 1000000)\n"
+            << "  --edges-per-vertex D  average out-degree of random graphs (default 4)\n"
+            << "  --seed S              seed for random and irreducible graphs (default 1)\n"
+            << "  --algorithm A         naive, lt, snca, iterative, auto or all; may be repeated (default all)\n"
+            << "  --repeat R            runs per algorithm (default 3)\n"
+            << "  --naive-limit N       skip the naive algorithm in 'all' above N vertices (default 20000)\n"
+            << "  --verify              check that all algorithms compute the same tree\n"
+            << "  --print               print idom of every vertex\n"
+            << "  --dot                 write semidominators.dot and dominator_tree.dot\n"
+            << "  --dot-format F        format of those files: dot, json or edges (default dot)\n"
+            << "Peak RSS only grows during a run, so run one algorithm per process to compare memory.\n";
+}
+
+static bool parse_algorithm(const std::string& name, std::vector<algorithm>& algorithms)
+{
+  if (name == "naive" || name == "all")
+    algorithms.push_back(algorithm::naive);
+  if (name == "lt" || name == "all")
+    algorithms.push_back(algorithm::lengauer_tarjan);
+  if (name == "snca" || name == "all")
+    algorithms.push_back(algorithm::semi_nca);
+  if (name == "iterative" || name == "all")
+    algorithms.push_back(algorithm::iterative);
+  if (name == "auto")
+    algorithms.push_back(algorithm::automatic);
+
+  return name == "naive" || name == "lt" || name == "snca" || name == "iterative" || name == "auto" || name == "all";
+}
+
+static bool parse_options(int argc, char** argv, options& opts)
+{
+  bool naive_requested = false;
 
-  void find_semi_dominator_candidates(int start_node, int current_node, std::vector<int>& candidates)
-  {
-    visited[current_node] = true;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
 
-    // Ukoliko je ulazna numeracija cvora koji je potencijalni kandidat manja u odnosu na numeraciju cvora za kog trazimo semidominatora,
-    // dodajemo ga u vektor kandidata.
-    if (in_numeration[start_node] > in_numeration[current_node]) {
-      candidates.push_back(current_node);
-      return;
+    if (arg == "--verify") {
+      opts.verify = true;
+      continue;
     }
-
-    // Ako prethodni uslov nije zadovoljen, krecemo se obrnutom putanjom od tekuceg cvora i razmatramo sve prethodno neposecene cvorove.
-    // Za njih vrsimo istu proveru.
-    for (int node : reversed_adjacency_list[current_node]) {
-      if (!visited[node])
-        find_semi_dominator_candidates(start_node, node, candidates);
+    if (arg == "--print") {
+      opts.print = true;
+      continue;
+    }
+    if (arg == "--dot") {
+      opts.dot = true;
+      continue;
     }
+    if (arg == "--help" || i + 1 == argc)
+      return false;
+
+    std::string value = argv[++i];
+    if (arg == "--input")
+      opts.input_file = value;
+    else if (arg == "--convert")
+      opts.convert_file = value;
+    else if (arg == "--generate")
+      opts.generator = value;
+    else if (arg == "--vertices")
+      opts.num_of_vertices = std::atoi(value.c_str());
+    else if (arg == "--edges-per-vertex")
+      opts.edges_per_vertex = std::atoi(value.c_str());
+    else if (arg == "--seed")
+      opts.seed = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--repeat")
+      opts.repeat = std::atoi(value.c_str());
+    else if (arg == "--naive-limit")
+      opts.naive_limit = std::atoi(value.c_str());
+    else if (arg == "--dot-format") {
+      if (value == "dot")
+        opts.dot_format = GraphFormat::Dot;
+      else if (value == "json")
+        opts.dot_format = GraphFormat::Json;
+      else if (value == "edges")
+        opts.dot_format = GraphFormat::EdgeList;
+      else
+        return false;
+    } else if (arg == "--algorithm") {
+      if (!parse_algorithm(value, opts.algorithms))
+        return false;
+      naive_requested = naive_requested || value == "naive";
+    } else
+      return false;
   }
 
-  int find_semi_dominator(int node)
-  {
-    std::vector<int> candidates;
-    // Posecene cvorove opet postavljamo na false, kako bismo ponavljali postupak trazenja kandidata za semidominatore.
-    std::fill(visited.begin(), visited.end(), false);
-
-    find_semi_dominator_candidates(node, node, candidates);
+  if (opts.algorithms.empty())
+    parse_algorithm("all", opts.algorithms);
+  if (naive_requested)
+    opts.naive_limit = std::numeric_limits<int>::max();
 
-    int min_numeration = std::numeric_limits<int>::max();
-    int semi_dominator;
+  return opts.num_of_vertices > 0 && opts.edges_per_vertex > 0 && opts.repeat > 0;
+}
 
-    // Od svih kandidata, semidominator je onaj cvor koji ima NAJMANJU ULAZNU NUMERACIJU.
-    for (int candidate : candidates) {
-      if (in_numeration[candidate] < min_numeration) {
-        min_numeration = in_numeration[candidate];
-        semi_dominator = candidate;
-      }
-    }
+static Graph example_graph()
+{
+  return Graph(8, {{0, 1}, {1, 2}, {1, 3}, {2, 3}, {2, 6}, {3, 4}, {4, 5}, {5, 7}, {7, 5}, {7, 6}, {6, 7}, {6, 2}});
+}
 
-    return semi_dominator;
+static bool make_graph(const options& opts, Graph& graph, std::string& error)
+{
+  if (!opts.input_file.empty() && is_binary_graph(opts.input_file))
+    return map_binary_graph(opts.input_file, graph, error);
+  if (!opts.input_file.empty())
+    return read_edge_list(opts.input_file, graph, error);
+
+  if (opts.generator == "random")
+    graph = generate_random_graph(opts.num_of_vertices, opts.edges_per_vertex, opts.seed);
+  else if (opts.generator == "ladder")
+    graph = generate_ladder_graph(opts.num_of_vertices);
+  else if (opts.generator == "deep-chain")
+    graph = generate_deep_chain_graph(opts.num_of_vertices);
+  else if (opts.generator == "irreducible")
+    graph = generate_irreducible_graph(opts.num_of_vertices, opts.seed);
+  else if (opts.generator == "example" || opts.generator.empty())
+    graph = example_graph();
+  else {
+    error = "unknown graph kind '" + opts.generator + "'";
+    return false;
   }
 
-public:
-  DominatorTree(int V)
-  {
-    num_of_vertices = V;
+  return true;
+}
+
+// Najveca zauzeta memorija procesa (ru_maxrss je u KB na Linux-u), u MB
+static double peak_memory_mb()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0;
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-    adjacency_list.resize(num_of_vertices);
-    reversed_adjacency_list.resize(num_of_vertices);
-    visited.resize(num_of_vertices, false);
-    in_numeration.resize(num_of_vertices, 0);
+int main(int argc, char** argv)
+{
+  options opts;
+  if (!parse_options(argc, argv, opts)) {
+    print_usage(argv[0]);
+    return 1;
+  }
 
-    sdom.resize(num_of_vertices);
-    for (int i = 0; i < num_of_vertices; ++i)
-      sdom[i] = i;
+  // Bez argumenata: mali primer, kao pre uvodjenja merenja
+  if (argc == 1) {
+    opts.algorithms = {algorithm::naive};
+    opts.repeat = 1;
+    opts.print = opts.dot = true;
   }
 
-  void add_edge(int u, int v)
-  {
-    adjacency_list[u].push_back(v);
-    reversed_adjacency_list[v].push_back(u);
+  Graph graph;
+  std::string error;
+  auto start = std::chrono::steady_clock::now();
+  if (!make_graph(opts, graph, error)) {
+    std::cerr << "error: " << error << "\n";
+    return 1;
   }
 
-  void DFS(int start_node, int &times)
-  {
-    visited[start_node] = true;
-    visited_order.push_back(start_node);
-    in_numeration[start_node] = times++;
+  std::string source = opts.input_file.empty() ? (opts.generator.empty() ? "example" : opts.generator) : opts.input_file;
+  std::cout << "graph: " << source << ", " << graph.get_num_of_vertices() << " vertices, " << graph.get_num_of_edges()
+            << " edges (" << std::fixed << std::setprecision(1) << elapsed_ms(start) << " ms, peak RSS "
+            << peak_memory_mb() << " MB)\n";
 
-    for (int node : adjacency_list[start_node]) {
-      if (!visited[node]) {
-        parents[node] = start_node;
-        DFS(node, times);
-      }
+  if (!opts.convert_file.empty()) {
+    if (!write_binary_graph(opts.convert_file, graph, error)) {
+      std::cerr << "error: " << error << "\n";
+      return 1;
     }
+    std::cout << "written " << opts.convert_file << "\n";
+    return 0;
   }
 
-  void find_semi_dominators()
-  {
-    // Semidominatore trazimo za cvorove u OBRNUTOM poretku od onog u kom smo ih obilazili prilikom DFS pretrage.
-    std::reverse(visited_order.begin(), visited_order.end());
+  std::cout << std::left << std::setw(18) << "algorithm" << std::right << std::setw(12) << "best ms" << std::setw(12)
+            << "mean ms" << std::setw(14) << "Mvertices/s" << std::setw(12) << "work MB" << std::setw(14)
+            << "peak RSS MB" << "\n";
 
-    for (int node : visited_order) {
-      // Pocetni cvor nema semidominatora, pa njega ignorisemo.
-      if (node == 0)
-        break;
+  std::vector<int> reference;
+  algorithm reference_algorithm = algorithm::naive;
+  bool mismatch = false;
 
-      sdom[node] = find_semi_dominator(node);
-//      std::cout << "sdom(" << node << ") = " << sdom[node] << "\n";
+  for (algorithm kind : opts.algorithms) {
+    if (kind == algorithm::naive && graph.get_num_of_vertices() > opts.naive_limit) {
+      std::cout << std::left << std::setw(18) << algorithm_name(kind) << "skipped (more than " << opts.naive_limit
+                << " vertices)\n";
+      continue;
     }
-  }
 
-  void find_immediate_dominators()
-  {
-    int parent, min;
+    double best = 0, total = 0;
+    size_t work = 0;
+    std::vector<int> idom;
 
-    // Za svaki cvor gledamo putanju do njegovog semidominatora
-    for (int node : visited_order) {
-      parent = parents[node];
-      min = sdom[node];
+    for (int i = 0; i < opts.repeat; ++i) {
+      DominatorTree dom_tree(graph);
 
-      while (parent != sdom[node]) {
-        if (sdom[parent] < min) {
-          min = sdom[parent];
-          ancestors[parent] = parent;
-        }
+      start = std::chrono::steady_clock::now();
+      dom_tree.run(kind);
+      double time = elapsed_ms(start);
 
-        parent = parents[parent];
-      }
-    }
+      best = i == 0 ? time : std::min(best, time);
+      total += time;
+      work = dom_tree.memory_usage();
 
-    // Vracamo se u poredak dobijen na pocetku pretrage
-    std::reverse(visited_order.begin(), visited_order.end());
+      if (i + 1 < opts.repeat)
+        continue;
 
-    for (int node : visited_order) {
-      if (ancestors[node] == -1)           // postoji grana od sdom[node] do node
-        idom[node] = sdom[node];
-    }
-
-    for (int node : visited_order) {
-      if (ancestors[node] != -1)
-        idom[node] = idom[ancestors[node]];
+      idom = dom_tree.get_immediate_dominators();
+      if (opts.dot) {
+        dom_tree.print_tree("semidominators", false, opts.dot_format);
+        dom_tree.print_tree("dominator_tree", true, opts.dot_format);
+      }
     }
 
-    for (int i = 0; i < num_of_vertices; ++i)
-      std::cout << "idom(" << i << ") = " << idom[i] << "\n";
-  }
+    std::cout << std::left << std::setw(18) << algorithm_name(kind) << std::right << std::setprecision(4)
+              << std::setw(12) << best << std::setw(12) << total / opts.repeat << std::setw(14)
+              << graph.get_num_of_vertices() / (best * 1000.0) << std::setprecision(1) << std::setw(12)
+              << work / (1024.0 * 1024.0) << std::setw(14) << peak_memory_mb() << "\n";
 
-  void print_tree(std::string file_name, bool dominator_tree)
-  {
-    std::ofstream file(file_name + ".dot");
-
-    file << "digraph \"" + file_name << " for 'main' function\" {\n";
-    file << "\tlabel=\"" + file_name << " for 'main' function\";\n";
-
-    for (int i = 0; i < num_of_vertices; ++i) {
-      file << "\t" << i
-           << " [shape=record, color=\"#072757\", style=filled, fillcolor=\"#2462bf\", label=\"{"
-           << i << "}\"];\n";
-      if (i != 0 && dominator_tree) {
-        file << "\t" << idom[i] << " -> " << i << ";\n";
-      } else if (i != 0 && !dominator_tree) {
-        file << "\t" << sdom[i] << " -> " << i << ";\n";
-      }
+    if (opts.print) {
+      for (int i = 0; i < graph.get_num_of_vertices(); ++i)
+        std::cout << "idom(" << i << ") = " << idom[i] << "\n";
     }
 
-    file << "}\n";
+    if (!opts.verify)
+      continue;
 
-    file.close();
+    if (reference.empty()) {
+      reference = std::move(idom);
+      reference_algorithm = kind;
+    } else if (idom != reference) {
+      std::cout << "mismatch: " << algorithm_name(kind) << " and " << algorithm_name(reference_algorithm)
+                << " computed different trees\n";
+      mismatch = true;
+    }
   }
-};
 
-int main ()
-{
-  DominatorTree dom_tree(8);
-
-  dom_tree.add_edge(0, 1);
-  dom_tree.add_edge(1, 2);
-  dom_tree.add_edge(1, 3);
-  dom_tree.add_edge(2, 3);
-  dom_tree.add_edge(2, 6);
-  dom_tree.add_edge(3, 4);
-  dom_tree.add_edge(4, 5);
-  dom_tree.add_edge(5, 7);
-  dom_tree.add_edge(7, 5);
-  dom_tree.add_edge(7, 6);
-  dom_tree.add_edge(6, 7);
-  dom_tree.add_edge(6, 2);
-
-  int times = 1;
-  dom_tree.DFS(0, times);
-  dom_tree.find_semi_dominators();
-  dom_tree.print_tree("semidominators", false);
-
-  dom_tree.find_immediate_dominators();
-  dom_tree.print_tree("dominator_tree", true);
-
-  return 0;
-}
\ No newline at end of file
+  return mismatch ? 2 : 0;
+}
@@ -0,0 +1,118 @@
+#include "DenseCFG.h"
+#include "llvm/IR/CFG.h"
+
+#include <mutex>
+
+// Brojanje po izvoru (odnosno odredistu) i prefiksne sume: stabilno, pa redosled naslednika
+// ostaje onakav kakav je u Edges
+void CSRGraph::Build(unsigned NumOfNodes, const std::vector<std::pair<unsigned, unsigned>> &Edges)
+{
+  SuccessorOffsets.assign(NumOfNodes + 1, 0);
+  PredecessorOffsets.assign(NumOfNodes + 1, 0);
+  SuccessorList.resize(Edges.size());
+  PredecessorList.resize(Edges.size());
+
+  for (auto &Edge : Edges) {
+    SuccessorOffsets[Edge.first + 1]++;
+    PredecessorOffsets[Edge.second + 1]++;
+  }
+
+  for (unsigned i = 0; i < NumOfNodes; ++i) {
+    SuccessorOffsets[i + 1] += SuccessorOffsets[i];
+    PredecessorOffsets[i + 1] += PredecessorOffsets[i];
+  }
+
+  std::vector<unsigned> NextSuccessor(SuccessorOffsets.begin(), SuccessorOffsets.end() - 1);
+  for (auto &Edge : Edges)
+    SuccessorList[NextSuccessor[Edge.first]++] = Edge.second;
+
+  // Prethodnici se upisuju obilaskom po izvoru, da bi bili poredjani po indeksu izvora
+  std::vector<unsigned> NextPredecessor(PredecessorOffsets.begin(), PredecessorOffsets.end() - 1);
+  for (unsigned Node = 0; Node < NumOfNodes; ++Node) {
+    for (unsigned Successor : GetSuccessors(Node))
+      PredecessorList[NextPredecessor[Successor]++] = Node;
+  }
+}
+
+DenseCFG::DenseCFG(Function &F)
+{
+  Build(F);
+}
+
+void DenseCFG::Build(Function &F)
+{
+  Blocks.clear();
+  BlockIndex.clear();
+
+  for (BasicBlock &BB : F) {
+    BlockIndex[&BB] = Blocks.size();
+    Blocks.push_back(&BB);
+  }
+
+  std::vector<std::pair<unsigned, unsigned>> Edges;
+  for (unsigned i = 0; i < Blocks.size(); ++i) {
+    for (BasicBlock *Successor : successors(Blocks[i]))
+      Edges.push_back({i, BlockIndex[Successor]});
+  }
+
+  Graph.Build(Blocks.size(), Edges);
+}
+
+// Sacuvani pokazivaci se samo porede, nikad ne dereferenciraju, pa je provera bezbedna i kada su
+// neki blokovi u medjuvremenu obrisani
+bool DenseCFG::Matches(Function &F) const
+{
+  unsigned Index = 0;
+
+  for (BasicBlock &BB : F) {
+    if (Index == Blocks.size() || Blocks[Index] != &BB)
+      return false;
+
+    ArrayRef<unsigned> Successors = Graph.GetSuccessors(Index);
+    unsigned k = 0;
+    for (BasicBlock *Successor : successors(&BB)) {
+      if (k == Successors.size() || Blocks[Successors[k]] != Successor)
+        return false;
+      k++;
+    }
+
+    if (k != Successors.size())
+      return false;
+    Index++;
+  }
+
+  return Index == Blocks.size();
+}
+
+static std::unordered_map<Function*, std::shared_ptr<const DenseCFG>> Cache;
+static std::mutex CacheLock;
+
+// Kes je zakljucan, pa Get moze da se zove iz vise niti, dok god niko istovremeno ne menja IR
+std::shared_ptr<const DenseCFG> DenseCFG::Get(Function &F)
+{
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  std::shared_ptr<const DenseCFG> &Entry = Cache[&F];
+
+  if (!Entry || !Entry->Matches(F))
+    Entry = std::make_shared<const DenseCFG>(F);
+
+  return Entry;
+}
+
+void DenseCFG::Release(Function &F)
+{
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  Cache.erase(&F);
+}
+
+void DenseCFG::Clear()
+{
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  Cache.clear();
+}
+
+int DenseCFG::GetIndex(BasicBlock *BB) const
+{
+  auto It = BlockIndex.find(BB);
+  return It == BlockIndex.end() ? -1 : (int)It->second;
+}
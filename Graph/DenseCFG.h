@@ -0,0 +1,79 @@
+#ifndef LLVM_PROJECT_DENSECFG_H
+#define LLVM_PROJECT_DENSECFG_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+// Graf sa cvorovima 0..N-1 u CSR (compressed sparse row) obliku: naslednici cvora i su
+// SuccessorList[SuccessorOffsets[i] .. SuccessorOffsets[i + 1]), isto i za prethodnike. Sve grane
+// su u dva niza, bez vektora i hes tabele po cvoru. Naslednici zadrzavaju redosled grana iz
+// kojih je graf napravljen, a prethodnici su poredjani po indeksu izvora.
+class CSRGraph {
+private:
+  std::vector<unsigned> SuccessorOffsets;
+  std::vector<unsigned> SuccessorList;
+  std::vector<unsigned> PredecessorOffsets;
+  std::vector<unsigned> PredecessorList;
+public:
+  void Build(unsigned NumOfNodes, const std::vector<std::pair<unsigned, unsigned>> &Edges);
+
+  unsigned GetNumOfNodes() const { return SuccessorOffsets.empty() ? 0 : SuccessorOffsets.size() - 1; }
+  unsigned GetNumOfEdges() const { return SuccessorList.size(); }
+
+  ArrayRef<unsigned> GetSuccessors(unsigned Node) const
+  {
+    return makeArrayRef(SuccessorList.data() + SuccessorOffsets[Node],
+                        SuccessorList.data() + SuccessorOffsets[Node + 1]);
+  }
+
+  ArrayRef<unsigned> GetPredecessors(unsigned Node) const
+  {
+    return makeArrayRef(PredecessorList.data() + PredecessorOffsets[Node],
+                        PredecessorList.data() + PredecessorOffsets[Node + 1]);
+  }
+};
+
+// CFG funkcije nad gustom numeracijom: BasicBlock-ovi dobijaju indekse redom kojim su u funkciji
+// (ulazni blok je 0), a grane su u CSRGraph-u. Get vraca graf iz kesa deljenog izmedju pasova
+// i analiza u istom plugin-u; pre vracanja se proverava da li graf i dalje odgovara funkciji
+// (isti blokovi i iste grane, samo poredjenjem pokazivaca). Graf se posle pravljenja ne menja:
+// kada se CFG funkcije izmeni, Get pravi novi graf, a ko drzi stari i dalje ima dosledan snimak.
+// Get sme da se zove iz vise niti istovremeno, ako se IR za to vreme ne menja.
+//
+// Kes sam ne zna kada je funkcija obrisana ili kada prestaje pokretanje pasova, pa ga pasovi
+// prazne u doFinalization (Clear). Release izbacuje graf jedne funkcije, npr. pre nego sto se
+// ona obrise; snimci koje neko jos drzi ostaju ispravni do poslednjeg shared_ptr-a.
+class DenseCFG {
+private:
+  std::vector<BasicBlock*> Blocks;
+  std::unordered_map<BasicBlock*, unsigned> BlockIndex;
+  CSRGraph Graph;
+
+  void Build(Function&);
+  bool Matches(Function&) const;
+public:
+  DenseCFG(Function&);
+
+  static std::shared_ptr<const DenseCFG> Get(Function&);
+  static void Release(Function&);
+  static void Clear();
+
+  const CSRGraph& GetGraph() const { return Graph; }
+  const std::vector<BasicBlock*>& GetBlocks() const { return Blocks; }
+  unsigned GetNumOfBlocks() const { return Blocks.size(); }
+  BasicBlock* GetBlock(unsigned Index) const { return Blocks[Index]; }
+  int GetIndex(BasicBlock*) const;
+
+  ArrayRef<unsigned> GetSuccessors(unsigned Index) const { return Graph.GetSuccessors(Index); }
+  ArrayRef<unsigned> GetPredecessors(unsigned Index) const { return Graph.GetPredecessors(Index); }
+};
+
+#endif // LLVM_PROJECT_DENSECFG_H
@@ -0,0 +1,121 @@
+#ifndef LLVM_PROJECT_DEPTHFIRSTSEARCH_H
+#define LLVM_PROJECT_DEPTHFIRSTSEARCH_H
+
+#include <iterator>
+#include <vector>
+
+// Obilazak u dubinu sa eksplicitnim stekom, zajednicki za sve grafove u projektu (BasicBlock-ovi,
+// funkcije u grafu poziva, celobrojni cvorovi). Na steku je cvor i iterator na sledeceg
+// naslednika, pa dubina grafa ne zavisi od velicine steka poziva.
+//
+// Successors(Node) vraca opseg naslednika koji mora da vazi dok traje obilazak: referencu na
+// kontejner ili llvm opseg kao sto je successors(BB), ali ne privremeni vektor.
+// Visit(Node, Parent) se poziva za pocetni cvor (sa Parent == Node) i za svaku obidjenu granu.
+// Vraca true ako cvor do sada nije posecen i u njega treba uci, a tada je to poziv u preorder-u.
+// Finish(Node) se poziva kada su obidjeni svi naslednici cvora, dakle u postorder-u.
+//
+// Posecenost cuva onaj ko poziva, pa guste numeracije mogu da koriste obican vektor.
+template <typename NodeT, typename SuccessorsT, typename VisitT, typename FinishT>
+void DepthFirstSearch(NodeT Start, SuccessorsT &&Successors, VisitT &&Visit, FinishT &&Finish)
+{
+  using IteratorT = decltype(std::begin(Successors(Start)));
+
+  struct Frame {
+    NodeT Node;
+    IteratorT Next;
+    IteratorT End;
+  };
+
+  if (!Visit(Start, Start))
+    return;
+
+  std::vector<Frame> Stack;
+  auto &&Range = Successors(Start);
+  Stack.push_back({Start, std::begin(Range), std::end(Range)});
+
+  while (!Stack.empty()) {
+    Frame &Top = Stack.back();
+
+    if (Top.Next == Top.End) {
+      NodeT Node = Top.Node;
+      Stack.pop_back();
+      Finish(Node);
+      continue;
+    }
+
+    NodeT Node = Top.Node;
+    NodeT Successor = *Top.Next++;
+    if (Visit(Successor, Node)) {
+      auto &&SuccessorRange = Successors(Successor);
+      Stack.push_back({Successor, std::begin(SuccessorRange), std::end(SuccessorRange)});
+    }
+  }
+}
+
+// Preorder, postorder i obrnuti postorder (RPO) obilaska nad gustom numeracijom cvorova
+// (0 .. NumOfNodes - 1), sa rednim brojevima cvorova i roditeljem u DFS stablu. Brojevi i
+// roditelji su obicni nizovi indeksirani cvorom, a -1 znaci da cvor nije posecen (odnosno da je
+// koren). Vise poziva Run nastavlja istu numeraciju (npr. za sve korene grafa poziva).
+template <typename NodeT>
+class DFSOrder {
+public:
+  std::vector<NodeT> Preorder;
+  std::vector<NodeT> Postorder;
+  std::vector<int> PreorderNumber;
+  std::vector<int> PostorderNumber;
+  std::vector<int> Parent;
+
+  explicit DFSOrder(unsigned NumOfNodes = 0)
+  {
+    Reset(NumOfNodes);
+  }
+
+  void Reset(unsigned NumOfNodes)
+  {
+    Preorder.clear();
+    Postorder.clear();
+    PreorderNumber.assign(NumOfNodes, -1);
+    PostorderNumber.assign(NumOfNodes, -1);
+    Parent.assign(NumOfNodes, -1);
+  }
+
+  template <typename SuccessorsT>
+  void Run(NodeT Start, SuccessorsT &&Successors)
+  {
+    DepthFirstSearch(
+        Start, Successors,
+        [this](NodeT Node, NodeT From) {
+          if (PreorderNumber[Node] != -1)
+            return false;
+
+          PreorderNumber[Node] = Preorder.size();
+          Preorder.push_back(Node);
+          Parent[Node] = Node == From ? -1 : (int)From;
+          return true;
+        },
+        [this](NodeT Node) {
+          PostorderNumber[Node] = Postorder.size();
+          Postorder.push_back(Node);
+        });
+  }
+
+  bool IsVisited(NodeT Node) const
+  {
+    return PreorderNumber[Node] != -1;
+  }
+
+  // Povratna grana vodi u pretka u DFS stablu (ili u isti cvor): odrediste je poseceno pre
+  // izvora, a zavrseno posle njega. Posle obilaska je to isto sto i grana ka cvoru na steku.
+  bool IsBackEdge(NodeT From, NodeT To) const
+  {
+    return IsVisited(From) && IsVisited(To) && PreorderNumber[To] <= PreorderNumber[From] &&
+           PostorderNumber[To] >= PostorderNumber[From];
+  }
+
+  std::vector<NodeT> ReversePostorder() const
+  {
+    return std::vector<NodeT>(Postorder.rbegin(), Postorder.rend());
+  }
+};
+
+#endif // LLVM_PROJECT_DEPTHFIRSTSEARCH_H
@@ -0,0 +1,279 @@
+#include "GraphExporter.h"
+
+#include <cerrno>
+#include <cstring>
+
+const char* GetGraphFileExtension(GraphFormat Format)
+{
+  switch (Format) {
+    case GraphFormat::Dot:
+      return ".dot";
+    case GraphFormat::Json:
+      return ".json";
+    case GraphFormat::EdgeList:
+      return ".edges";
+  }
+  return "";
+}
+
+GraphExporter::GraphExporter(const GraphExportOptions &Options, const std::string &Title, GraphNodeStyle Style)
+  : Options(Options), Style(Style)
+{
+  switch (Options.Format) {
+    case GraphFormat::Dot:
+      Buffer += "digraph \"";
+      AppendDotLabel(Title);
+      Buffer += "\" {\n\tlabel=\"";
+      AppendDotLabel(Title);
+      Buffer += "\";\n\n";
+      break;
+    case GraphFormat::Json:
+      Buffer += "{\n  \"graph\": ";
+      AppendJsonString(Title);
+      Buffer += ",\n  \"nodes\": [";
+      break;
+    case GraphFormat::EdgeList:
+      Buffer += "# ";
+      Buffer += Title;
+      Buffer += "\n";
+      break;
+  }
+}
+
+GraphExporter::~GraphExporter()
+{
+  if (File)
+    std::fclose(File);
+}
+
+// U labeli record cvora {, }, |, < i > imaju posebno znacenje, pa se (kao i " i \) pisu sa \.
+// Novi red postaje \l, kraj levo poravnatog reda.
+void GraphExporter::AppendDotLabel(const std::string &Text)
+{
+  for (char C : Text) {
+    switch (C) {
+      case '{': case '}': case '|': case '<': case '>': case '"': case '\\':
+        Buffer += '\\';
+        Buffer += C;
+        break;
+      case '\n':
+        Buffer += "\\l ";
+        break;
+      default:
+        Buffer += C;
+    }
+  }
+}
+
+void GraphExporter::AppendJsonString(const std::string &Text)
+{
+  static const char* Hex = "0123456789abcdef";
+
+  Buffer += '"';
+  for (char C : Text) {
+    unsigned char Byte = C;
+
+    if (C == '"' || C == '\\') {
+      Buffer += '\\';
+      Buffer += C;
+    } else if (C == '\n') {
+      Buffer += "\\n";
+    } else if (Byte < 0x20) {
+      Buffer += "\\u00";
+      Buffer += Hex[Byte >> 4];
+      Buffer += Hex[Byte & 15];
+    } else {
+      Buffer += C;
+    }
+  }
+  Buffer += '"';
+}
+
+bool GraphExporter::Open(const std::string &FileName, std::string &Error)
+{
+  File = std::fopen(FileName.c_str(), "wb");
+  if (!File) {
+    Error = FileName + ": " + std::strerror(errno);
+    return false;
+  }
+
+  return Flush();
+}
+
+// Greska pri upisu se pamti, jer AddNode i AddEdge ne vracaju rezultat, pa je prijavljuje Close
+bool GraphExporter::Flush()
+{
+  if (!File)
+    return true;
+  if (WriteFailed) {
+    Buffer.clear();
+    return false;
+  }
+
+  if (std::fwrite(Buffer.data(), 1, Buffer.size(), File) != Buffer.size()) {
+    WriteFailed = true;
+    WriteError = std::strerror(errno);
+  }
+  Buffer.clear();
+  return !WriteFailed;
+}
+
+void GraphExporter::AddNode(unsigned Id, const std::string &Name, const std::string &Body,
+                            const std::vector<std::string> &Ports)
+{
+  bool WithBody = GetBodies() && !Body.empty();
+
+  switch (Options.Format) {
+    case GraphFormat::Dot:
+      Buffer += "\tNode";
+      Buffer += std::to_string(Id);
+      Buffer += " [shape=record, color=\"";
+      Buffer += Style.Color;
+      Buffer += "\", style=filled, fillcolor=\"";
+      Buffer += Style.FillColor;
+      Buffer += "\", label=\"{";
+      AppendDotLabel(Name);
+
+      if (WithBody) {
+        Buffer += "\\l ";
+        AppendDotLabel(Body);
+        if (Body.back() != '\n')
+          Buffer += "\\l ";
+      }
+
+      if (!Ports.empty()) {
+        Buffer += "|{";
+        for (unsigned i = 0; i < Ports.size(); ++i) {
+          Buffer += i == 0 ? "<s" : "|<s";
+          Buffer += std::to_string(i);
+          Buffer += '>';
+          AppendDotLabel(Ports[i]);
+        }
+        Buffer += '}';
+      }
+
+      Buffer += "}\"];\n";
+      break;
+
+    case GraphFormat::Json:
+      Buffer += FirstNode ? "\n    {\"id\": " : ",\n    {\"id\": ";
+      Buffer += std::to_string(Id);
+      Buffer += ", \"name\": ";
+      AppendJsonString(Name);
+
+      if (WithBody) {
+        Buffer += ", \"body\": ";
+        AppendJsonString(Body);
+      }
+
+      if (!Ports.empty()) {
+        Buffer += ", \"ports\": [";
+        for (unsigned i = 0; i < Ports.size(); ++i) {
+          if (i > 0)
+            Buffer += ", ";
+          AppendJsonString(Ports[i]);
+        }
+        Buffer += ']';
+      }
+
+      Buffer += '}';
+      break;
+
+    case GraphFormat::EdgeList:
+      Buffer += "# ";
+      Buffer += std::to_string(Id);
+      Buffer += ' ';
+      Buffer += Name;
+      Buffer += '\n';
+      break;
+  }
+
+  FirstNode = false;
+  if (Buffer.size() >= FlushThreshold)
+    Flush();
+}
+
+void GraphExporter::AddEdge(unsigned From, unsigned To, int Port)
+{
+  switch (Options.Format) {
+    case GraphFormat::Dot:
+      Buffer += "\tNode";
+      Buffer += std::to_string(From);
+      if (Port >= 0) {
+        Buffer += ":s";
+        Buffer += std::to_string(Port);
+      }
+      Buffer += " -> Node";
+      Buffer += std::to_string(To);
+      Buffer += ";\n";
+      break;
+
+    case GraphFormat::Json:
+      EdgeBuffer += FirstEdge ? "\n    [" : ",\n    [";
+      EdgeBuffer += std::to_string(From);
+      EdgeBuffer += ", ";
+      EdgeBuffer += std::to_string(To);
+      if (Port >= 0) {
+        EdgeBuffer += ", ";
+        EdgeBuffer += std::to_string(Port);
+      }
+      EdgeBuffer += ']';
+      break;
+
+    case GraphFormat::EdgeList:
+      Buffer += std::to_string(From);
+      Buffer += ' ';
+      Buffer += std::to_string(To);
+      Buffer += '\n';
+      break;
+  }
+
+  FirstEdge = false;
+  if (Buffer.size() >= FlushThreshold)
+    Flush();
+}
+
+bool GraphExporter::Close(std::string &Error)
+{
+  if (!Closed) {
+    Closed = true;
+
+    if (Options.Format == GraphFormat::Dot) {
+      Buffer += "}\n";
+    } else if (Options.Format == GraphFormat::Json) {
+      Buffer += FirstNode ? "],\n  \"edges\": [" : "\n  ],\n  \"edges\": [";
+      Buffer += EdgeBuffer;
+      Buffer += FirstEdge ? "]\n}\n" : "\n  ]\n}\n";
+      EdgeBuffer.clear();
+    }
+  }
+
+  if (!File)
+    return true;
+
+  bool Written = Flush();
+  bool ClosedFile = std::fclose(File) == 0;
+  File = nullptr;
+
+  if (!Written)
+    Error = "write failed: " + WriteError;
+  else if (!ClosedFile)
+    Error = std::string("write failed: ") + std::strerror(errno);
+  return Written && ClosedFile;
+}
+
+bool GraphExporter::WriteFile(const std::string &FileName, const std::string &Text, std::string &Error)
+{
+  std::FILE* Out = std::fopen(FileName.c_str(), "wb");
+  if (!Out) {
+    Error = FileName + ": " + std::strerror(errno);
+    return false;
+  }
+
+  bool Written = std::fwrite(Text.data(), 1, Text.size(), Out) == Text.size();
+  Written = std::fclose(Out) == 0 && Written;
+
+  if (!Written)
+    Error = FileName + ": " + std::strerror(errno);
+  return Written;
+}
@@ -0,0 +1,88 @@
+#ifndef LLVM_PROJECT_GRAPHEXPORTER_H
+#define LLVM_PROJECT_GRAPHEXPORTER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Format u kom se graf ispisuje:
+//  Dot      - graphviz, kao do sada (record cvorovi sa imenom, telom i izlazima za grane)
+//  Json     - {"graph": ..., "nodes": [{"id", "name", "body"}], "edges": [[od, do, izlaz]]}
+//  EdgeList - "od do" u svakom redu, a imena cvorova u komentarima "# id ime"; isti format cita
+//             alat Dominators (--input), pa se CFG iz pasa moze direktno meriti
+enum class GraphFormat {
+  Dot,
+  Json,
+  EdgeList
+};
+
+struct GraphExportOptions {
+  GraphFormat Format = GraphFormat::Dot;
+  // Bez tela cvorova (instrukcija BasicBlock-a) ostaju samo imena i grane, sto je daleko brze za
+  // velike funkcije
+  bool Bodies = true;
+};
+
+// Boje record cvorova u .dot fajlu
+struct GraphNodeStyle {
+  const char* Color;
+  const char* FillColor;
+};
+
+// Ekstenzija fajla sa tackom (".dot", ".json", ".edges")
+const char* GetGraphFileExtension(GraphFormat);
+
+// Zajednicki ispis grafova (CFG, stabla dominatora, graf poziva). Cvorovi su oznaceni brojevima
+// koje bira pozivalac, pa izlaz ne zavisi od adresa u memoriji i dva pokretanja mogu da se porede.
+// Sve se pise u jedan bafer (bez formatiranja kroz stream za svaki deo), a ako je otvoren fajl,
+// bafer se prazni u njega jednim fwrite-om cim predje FlushThreshold bajtova.
+//
+// U Json-u grane idu posle svih cvorova, pa se skupljaju u poseban bafer do Close.
+class GraphExporter {
+private:
+  GraphExportOptions Options;
+  GraphNodeStyle Style;
+  std::string Buffer;
+  std::string EdgeBuffer;
+  std::FILE* File = nullptr;
+  bool FirstNode = true;
+  bool FirstEdge = true;
+  bool Closed = false;
+  // Prvi neuspeli upis u fajl; posle njega se bafer vise ne upisuje, a Close vraca gresku
+  bool WriteFailed = false;
+  std::string WriteError;
+
+  static const size_t FlushThreshold = 1 << 20;
+
+  void AppendDotLabel(const std::string&);
+  void AppendJsonString(const std::string&);
+  bool Flush();
+public:
+  GraphExporter(const GraphExportOptions&, const std::string &Title, GraphNodeStyle);
+  ~GraphExporter();
+
+  GraphExporter(const GraphExporter&) = delete;
+  GraphExporter& operator=(const GraphExporter&) = delete;
+
+  // Ispis se od sada prazni u fajl; inace ceo graf ostaje u baferu (GetText)
+  bool Open(const std::string &FileName, std::string &Error);
+
+  // Body su redovi odvojeni sa '\n' (ignorise se ako Options.Bodies nije postavljeno), a Ports
+  // imenovani izlazi cvora (npr. T i F za uslovni skok), na koje se grane vezuju indeksom
+  void AddNode(unsigned Id, const std::string &Name, const std::string &Body = "",
+               const std::vector<std::string> &Ports = {});
+  // Port -1 znaci granu iz samog cvora, a ne iz nekog njegovog izlaza
+  void AddEdge(unsigned From, unsigned To, int Port = -1);
+
+  // Zavrsava graf i, ako je fajl otvoren, upisuje ostatak bafera i zatvara ga
+  bool Close(std::string &Error);
+  // Ceo tekst grafa posle Close, ako fajl nije otvoren
+  const std::string& GetText() const { return Buffer; }
+
+  bool GetBodies() const { return Options.Bodies && Options.Format != GraphFormat::EdgeList; }
+
+  // Upis vec ispisanog grafa u fajl, npr. iz niti koja samo pise fajlove
+  static bool WriteFile(const std::string &FileName, const std::string &Text, std::string &Error);
+};
+
+#endif // LLVM_PROJECT_GRAPHEXPORTER_H
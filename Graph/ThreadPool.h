@@ -0,0 +1,93 @@
+#ifndef LLVM_PROJECT_THREADPOOL_H
+#define LLVM_PROJECT_THREADPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fiksan broj niti koje uzimaju poslove iz zajednickog reda. Async moze da se poziva i iz samih
+// poslova (npr. posao na jednoj grupi niti predaje upis fajla drugoj), a Wait ceka dok red ne
+// ostane prazan i svi zapoceti poslovi ne zavrse. Destruktor ceka preostale poslove.
+class ThreadPool {
+private:
+  std::vector<std::thread> Workers;
+  std::deque<std::function<void()>> Queue;
+  std::mutex Lock;
+  std::condition_variable WorkAvailable;
+  std::condition_variable AllDone;
+  unsigned NumOfActive = 0;
+  bool Stopping = false;
+
+  void Work()
+  {
+    while (true) {
+      std::function<void()> Job;
+      {
+        std::unique_lock<std::mutex> Guard(Lock);
+        WorkAvailable.wait(Guard, [this] { return Stopping || !Queue.empty(); });
+        if (Queue.empty())
+          return;
+
+        Job = std::move(Queue.front());
+        Queue.pop_front();
+        NumOfActive++;
+      }
+
+      Job();
+
+      std::lock_guard<std::mutex> Guard(Lock);
+      NumOfActive--;
+      if (Queue.empty() && NumOfActive == 0)
+        AllDone.notify_all();
+    }
+  }
+
+public:
+  // 0 znaci po jedna nit za svako jezgro
+  explicit ThreadPool(unsigned NumOfThreads = 0)
+  {
+    if (NumOfThreads == 0)
+      NumOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < NumOfThreads; ++i)
+      Workers.emplace_back([this] { Work(); });
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      Stopping = true;
+    }
+    WorkAvailable.notify_all();
+
+    for (std::thread &Worker : Workers)
+      Worker.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned GetNumOfThreads() const { return Workers.size(); }
+
+  void Async(std::function<void()> Job)
+  {
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      Queue.push_back(std::move(Job));
+    }
+    WorkAvailable.notify_one();
+  }
+
+  void Wait()
+  {
+    std::unique_lock<std::mutex> Guard(Lock);
+    AllDone.wait(Guard, [this] { return Queue.empty() && NumOfActive == 0; });
+  }
+};
+
+#endif // LLVM_PROJECT_THREADPOOL_H
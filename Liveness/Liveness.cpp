@@ -0,0 +1,184 @@
+#include "Liveness.h"
+
+#include <deque>
+
+Liveness::Liveness(Function &F)
+{
+  NumOfIterations = 0;
+
+  NumberValues(F);
+  NumberBlocks(F);
+  ComputePostOrder();
+  ComputeLocalSets();
+}
+
+void Liveness::NumberValues(Function &F)
+{
+  for (Argument &Arg : F.args()) {
+    ValueIndex[&Arg] = Values.size();
+    Values.push_back(&Arg);
+  }
+
+  for (BasicBlock &BB : F) {
+    for (Instruction &Instr : BB) {
+      if (Instr.getType()->isVoidTy())
+        continue;
+
+      ValueIndex[&Instr] = Values.size();
+      Values.push_back(&Instr);
+    }
+  }
+}
+
+// Numeracija blokova i grane su iz zajednickog DenseCFG-a
+void Liveness::NumberBlocks(Function &F)
+{
+  Graph = DenseCFG::Get(F);
+}
+
+void Liveness::ComputePostOrder()
+{
+  std::vector<bool> Visited(Graph->GetNumOfBlocks(), false);
+
+  if (Graph->GetNumOfBlocks() == 0)
+    return;
+
+  DepthFirstSearch(
+      0u,
+      [this](unsigned Current) { return Graph->GetSuccessors(Current); },
+      [&Visited](unsigned Successor, unsigned) {
+        if (Visited[Successor])
+          return false;
+        Visited[Successor] = true;
+        return true;
+      },
+      [this](unsigned Current) { PostOrder.push_back(Current); });
+
+  for (unsigned i = 0; i < Graph->GetNumOfBlocks(); ++i)
+    if (!Visited[i])
+      PostOrder.push_back(i);
+}
+
+int Liveness::GetIndex(Value *V)
+{
+  if (!isa<Instruction>(V) && !isa<Argument>(V))
+    return -1;
+
+  auto It = ValueIndex.find(V);
+  return It == ValueIndex.end() ? -1 : (int)It->second;
+}
+
+void Liveness::ComputeLocalSets()
+{
+  unsigned NumOfBlocks = Graph->GetNumOfBlocks();
+  unsigned NumOfValues = Values.size();
+
+  UpwardExposed.assign(NumOfBlocks, BitVector(NumOfValues));
+  Defs.assign(NumOfBlocks, BitVector(NumOfValues));
+  PhiUses.assign(NumOfBlocks, BitVector(NumOfValues));
+  LiveIn.assign(NumOfBlocks, BitVector(NumOfValues));
+  LiveOut.assign(NumOfBlocks, BitVector(NumOfValues));
+
+  for (unsigned i = 0; i < NumOfBlocks; ++i) {
+    for (Instruction &Instr : *Graph->GetBlock(i)) {
+      // Operandi phi cvora se koriste na kraju odgovarajuceg prethodnika
+      if (auto *Phi = dyn_cast<PHINode>(&Instr)) {
+        for (unsigned k = 0; k < Phi->getNumIncomingValues(); ++k) {
+          int Index = GetIndex(Phi->getIncomingValue(k));
+          int Incoming = Graph->GetIndex(Phi->getIncomingBlock(k));
+          if (Index != -1 && Incoming != -1)
+            PhiUses[Incoming].set(Index);
+        }
+      } else {
+        for (Value *Operand : Instr.operands()) {
+          int Index = GetIndex(Operand);
+          if (Index != -1 && !Defs[i].test(Index))
+            UpwardExposed[i].set(Index);
+        }
+      }
+
+      int Index = GetIndex(&Instr);
+      if (Index != -1)
+        Defs[i].set(Index);
+    }
+  }
+}
+
+// Problem je unazad, pa blokove obradjujemo u post-order redosledu: successor je (osim za
+// povratne grane) obradjen pre svog prethodnika i vecina blokova se poseti samo jednom.
+void Liveness::Analyze()
+{
+  std::deque<unsigned> Worklist(PostOrder.begin(), PostOrder.end());
+  std::vector<bool> InWorklist(Graph->GetNumOfBlocks(), true);
+  BitVector NewLiveIn;
+
+  NumOfIterations = 0;
+
+  while (!Worklist.empty()) {
+    unsigned Current = Worklist.front();
+    Worklist.pop_front();
+    InWorklist[Current] = false;
+    NumOfIterations++;
+
+    BitVector &Out = LiveOut[Current];
+    Out = PhiUses[Current];
+    for (unsigned Successor : Graph->GetSuccessors(Current))
+      Out |= LiveIn[Successor];
+
+    NewLiveIn = Out;
+    NewLiveIn.reset(Defs[Current]);
+    NewLiveIn |= UpwardExposed[Current];
+
+    if (NewLiveIn == LiveIn[Current])
+      continue;
+
+    LiveIn[Current] = NewLiveIn;
+    for (unsigned Predecessor : Graph->GetPredecessors(Current)) {
+      if (!InWorklist[Predecessor]) {
+        InWorklist[Predecessor] = true;
+        Worklist.push_back(Predecessor);
+      }
+    }
+  }
+}
+
+const BitVector& Liveness::GetLiveIn(BasicBlock *BB)
+{
+  return LiveIn[Graph->GetIndex(BB)];
+}
+
+const BitVector& Liveness::GetLiveOut(BasicBlock *BB)
+{
+  return LiveOut[Graph->GetIndex(BB)];
+}
+
+bool Liveness::IsLiveIn(Value *V, BasicBlock *BB)
+{
+  int Index = GetIndex(V);
+  return Index != -1 && GetLiveIn(BB).test(Index);
+}
+
+bool Liveness::IsLiveOut(Value *V, BasicBlock *BB)
+{
+  int Index = GetIndex(V);
+  return Index != -1 && GetLiveOut(BB).test(Index);
+}
+
+void Liveness::Print(raw_ostream &Out)
+{
+  for (BasicBlock *BB : Graph->GetBlocks()) {
+    BB->printAsOperand(Out, false);
+    Out << "\n\tlive-in: ";
+    for (unsigned Index : GetLiveIn(BB).set_bits()) {
+      Values[Index]->printAsOperand(Out, false);
+      Out << " ";
+    }
+
+    Out << "\n\tlive-out: ";
+    for (unsigned Index : GetLiveOut(BB).set_bits()) {
+      Values[Index]->printAsOperand(Out, false);
+      Out << " ";
+    }
+    Out << "\n";
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef LLVM_PROJECT_LIVENESS_H
+#define LLVM_PROJECT_LIVENESS_H
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../Graph/DenseCFG.h"
+#include "../Graph/DepthFirstSearch.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace llvm;
+
+// Analiza zivosti SSA vrednosti (argumenti i instrukcije koje vracaju vrednost). Vrednosti i
+// BasicBlock-ovi su numerisani gusto, pa su skupovi po bloku BitVector-i i sve operacije nad
+// njima (unija, razlika) se rade rec po rec.
+//
+//   LiveOut(B) = unija LiveIn(S) za sve successore S  |  PhiUses(B)
+//   LiveIn(B)  = UpwardExposed(B)  |  (LiveOut(B) & ~Defs(B))
+//
+// PhiUses(B) su vrednosti koje iz B ulaze u phi cvorove successora; one su zive na izlazu iz B,
+// a ne na ulazu u blok phi cvora.
+class Liveness {
+private:
+  std::unordered_map<Value*, unsigned> ValueIndex;
+  std::vector<Value*> Values;
+
+  std::shared_ptr<const DenseCFG> Graph;
+
+  std::vector<BitVector> UpwardExposed;
+  std::vector<BitVector> Defs;
+  std::vector<BitVector> PhiUses;
+  std::vector<BitVector> LiveIn;
+  std::vector<BitVector> LiveOut;
+
+  // Post-order obilazak od ulaznog bloka; nedostizni blokovi su na kraju
+  std::vector<unsigned> PostOrder;
+  unsigned NumOfIterations;
+
+  void NumberValues(Function&);
+  void NumberBlocks(Function&);
+  void ComputePostOrder();
+  void ComputeLocalSets();
+  int GetIndex(Value*);
+public:
+  Liveness(Function&);
+
+  void Analyze();
+
+  unsigned GetNumOfValues() { return Values.size(); }
+  unsigned GetNumOfBlocks() { return Graph->GetNumOfBlocks(); }
+  unsigned GetNumOfIterations() { return NumOfIterations; }
+
+  Value* GetValue(unsigned Index) { return Values[Index]; }
+  const BitVector& GetLiveIn(BasicBlock*);
+  const BitVector& GetLiveOut(BasicBlock*);
+  bool IsLiveIn(Value*, BasicBlock*);
+  bool IsLiveOut(Value*, BasicBlock*);
+
+  void Print(raw_ostream&);
+};
+
+#endif // LLVM_PROJECT_LIVENESS_H
@@ -0,0 +1,151 @@
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "Liveness.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<unsigned> BenchmarkBlocks("liveness-benchmark-blocks", cl::init(10000),
+                                         cl::desc("Approximate number of basic blocks in the generated function"));
+static cl::opt<unsigned> BenchmarkValues("liveness-benchmark-values", cl::init(256),
+                                         cl::desc("Number of long-lived values defined in the entry block"));
+
+namespace {
+
+struct OurLivenessPass : public FunctionPass {
+  static char ID;
+  OurLivenessPass() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override {
+    if (F.isDeclaration())
+      return false;
+
+    Liveness *Analysis = new Liveness(F);
+    Analysis->Analyze();
+
+    errs() << "======= LIVENESS: " << F.getName() << " =======\n";
+    Analysis->Print(errs());
+    errs() << "\n";
+
+    delete Analysis;
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
+};
+
+// Benchmark ne koristi ulazni modul, vec generise funkciju sa zadatim brojem blokova:
+// niz if-then dijamanata sa phi cvorom na spoju, povratnom granom na svakih 64 segmenta i
+// vrednostima iz ulaznog bloka koje se koriste do samog kraja, pa su zive kroz ceo graf.
+struct OurLivenessBenchmarkPass : public ModulePass {
+  static char ID;
+  OurLivenessBenchmarkPass() : ModulePass(ID) {}
+
+  Function* CreateFunction(Module &M, unsigned NumOfSegments, unsigned NumOfValues)
+  {
+    LLVMContext &Context = M.getContext();
+    Type *Int32 = Type::getInt32Ty(Context);
+    FunctionType *Type = FunctionType::get(Int32, {Int32}, false);
+    Function *F = Function::Create(Type, Function::InternalLinkage, "liveness_benchmark", M);
+
+    Value *A = F->getArg(0);
+    BasicBlock *Entry = BasicBlock::Create(Context, "entry", F);
+    IRBuilder<> Builder(Entry);
+
+    std::vector<Value *> LongLived = {};
+    for (unsigned i = 0; i < NumOfValues; ++i)
+      LongLived.push_back(Builder.CreateAdd(A, Builder.getInt32(i)));
+
+    std::vector<BasicBlock *> Heads = {};
+    Value *Current = A;
+    BasicBlock *Previous = Entry;
+
+    for (unsigned i = 0; i < NumOfSegments; ++i) {
+      BasicBlock *Head = BasicBlock::Create(Context, "head", F);
+      BasicBlock *Then = BasicBlock::Create(Context, "then", F);
+      BasicBlock *Join = BasicBlock::Create(Context, "join", F);
+      Heads.push_back(Head);
+
+      Builder.SetInsertPoint(Previous);
+      Builder.CreateBr(Head);
+
+      Builder.SetInsertPoint(Head);
+      Value *Next = Builder.CreateAdd(Current, LongLived[i % NumOfValues]);
+      Builder.CreateCondBr(Builder.CreateICmpSGT(Next, A), Then, Join);
+
+      Builder.SetInsertPoint(Then);
+      Value *Product = Builder.CreateMul(Next, Builder.getInt32(3));
+      Builder.CreateBr(Join);
+
+      Builder.SetInsertPoint(Join);
+      PHINode *Phi = Builder.CreatePHI(Int32, 2);
+      Phi->addIncoming(Next, Head);
+      Phi->addIncoming(Product, Then);
+      Current = Phi;
+
+      if (i % 64 == 63) {
+        BasicBlock *Latch = BasicBlock::Create(Context, "latch", F);
+        Builder.CreateCondBr(Builder.CreateICmpEQ(Phi, A), Heads[i - 63], Latch);
+        Previous = Latch;
+      } else {
+        Previous = Join;
+      }
+    }
+
+    Builder.SetInsertPoint(Previous);
+    for (Value *V : LongLived)
+      Current = Builder.CreateXor(Current, V);
+    Builder.CreateRet(Current);
+
+    return F;
+  }
+
+  bool runOnModule(Module &M) override {
+    unsigned NumOfValues = BenchmarkValues == 0 ? 1 : (unsigned)BenchmarkValues;
+    unsigned NumOfSegments = BenchmarkBlocks / 3 + 1;
+
+    Module BenchmarkModule("liveness_benchmark", M.getContext());
+    Function *F = CreateFunction(BenchmarkModule, NumOfSegments, NumOfValues);
+
+    auto Start = std::chrono::steady_clock::now();
+    Liveness *Analysis = new Liveness(*F);
+    auto Built = std::chrono::steady_clock::now();
+    Analysis->Analyze();
+    auto End = std::chrono::steady_clock::now();
+
+    double BuildTime = std::chrono::duration<double, std::milli>(Built - Start).count();
+    double SolveTime = std::chrono::duration<double, std::milli>(End - Built).count();
+
+    errs() << "blocks: " << Analysis->GetNumOfBlocks() << "\n"
+           << "values: " << Analysis->GetNumOfValues() << "\n"
+           << "block visits: " << Analysis->GetNumOfIterations() << "\n"
+           << "numbering and local sets: " << format("%.3f", BuildTime) << " ms\n"
+           << "dataflow: " << format("%.3f", SolveTime) << " ms\n"
+           << "blocks/s: " << format("%.0f", Analysis->GetNumOfBlocks() / ((BuildTime + SolveTime) / 1000.0)) << "\n";
+
+    delete Analysis;
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
+};
+}
+
+char OurLivenessPass::ID = 0;
+static RegisterPass<OurLivenessPass> X("print-our-liveness", "Print live-in and live-out values of every basic block");
+
+char OurLivenessBenchmarkPass::ID = 0;
+static RegisterPass<OurLivenessBenchmarkPass> Y("liveness-benchmark", "Time the liveness analysis on a generated function");
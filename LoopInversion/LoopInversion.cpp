@@ -1,21 +1,12 @@
 #include "llvm/IR/Instruction.h"
-#include "llvm/Transforms/Utils.h"
-#include "llvm/Transforms/Utils/LoopPeel.h"
-#include "llvm/Transforms/Utils/LoopSimplify.h"
-#include "llvm/Transforms/Utils/LoopUtils.h"
-#include "llvm/Transforms/Utils/SizeOpts.h"
-#include "llvm/Transforms/Utils/UnrollLoop.h"
-#include "llvm/Analysis/LoopAnalysisManager.h"
-#include "llvm/Analysis/LoopInfo.h"
-#include "llvm/Analysis/LoopUnrollAnalyzer.h"
-#include "llvm/Transforms/Utils/BasicBlockUtils.h"
-#include "llvm/Transforms/Utils/LoopUtils.h"
-#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
-#include "llvm/Analysis/LoopPass.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/IR/IRBuilder.h"
+#include "../DominatorTreePass/DominatorTree.h"
+#include "../DominatorTreePass/LoopNestingForest.h"
 
 #include <unordered_map>
 #include <vector>
@@ -24,9 +15,9 @@ using namespace llvm;
 
 namespace {
 
-struct LoopInversionPass : public LoopPass {
+struct LoopInversionPass : public FunctionPass {
   static char ID;
-  LoopInversionPass() : LoopPass(ID) {};
+  LoopInversionPass() : FunctionPass(ID) {};
 
   int CounterValue = -1;
   int BoundValue = -1;
@@ -56,7 +47,7 @@ struct LoopInversionPass : public LoopPass {
     }
   }
 
-  void FindLoopBoundAndCounter(Loop *L)
+  void FindLoopBoundAndCounter(OurLoop *L)
   {
     // %5 = icmp slt i32 %4, 10
     for (Instruction &Instr : *LoopBasicBlocks[0]) {
@@ -74,7 +65,7 @@ struct LoopInversionPass : public LoopPass {
 
     // Vrednost brojaca:
     // store i32 0, ptr %2, align 4
-    for (Instruction &Instr : *L->getLoopPreheader()) {
+    for (Instruction &Instr : *L->GetPreheader()) {
       if (isa<StoreInst>(&Instr) && Instr.getOperand(1) == LoopCounter) {
         ConstantInt *ConstInt = dyn_cast<ConstantInt>(Instr.getOperand(0));
         CounterValue = ConstInt->getSExtValue();
@@ -142,7 +133,7 @@ struct LoopInversionPass : public LoopPass {
 //    return NewBasicBlock;
 //  }
 
-  void LoopInversion(Loop *L)
+  void LoopInversion(OurLoop *L)
   {
     // BasicBlock *NewBasicBlock = CreateBasicBlock();
     // Alternativa za kopiranje BB jeste da se sve instrukcije kreiraju rucno
@@ -165,14 +156,14 @@ struct LoopInversionPass : public LoopPass {
       errs() << "\n";
     }
 
-    L->getLoopPreheader()->getTerminator()->setSuccessor(0, NewBasicBlock);
+    L->GetPreheader()->getTerminator()->setSuccessor(0, NewBasicBlock);
     LoopBasicBlocks.front()->moveBefore(LoopBasicBlocks.back());
     CopyInstructions(LoopBasicBlocks.back(), LoopBasicBlocks[LoopBasicBlocks.size() - 2]);
 //    LoopBasicBlocks.back()->eraseFromParent(); <- ovde puca
   }
 
-  bool runOnLoop(Loop *L, LPPassManager &) override {
-    LoopBasicBlocks = L->getBlocksVector();
+  bool RunOnLoop(OurLoop *L) {
+    LoopBasicBlocks = L->GetBlocks();
 
     errs() << "--- Loop basic blocks ---\n";
     for (BasicBlock *BB : LoopBasicBlocks) {
@@ -186,6 +177,33 @@ struct LoopInversionPass : public LoopPass {
 
     return true;
   }
+
+  // Petlje se nalaze nasim stablom dominatora i sumom petlji, jednom pre izmena, i obradjuju se od
+  // unutrasnjih ka spoljasnjim, kao u LoopPass-u. Nesvodljive petlje se sada vide, ali se preskacu.
+  bool runOnFunction(Function &F) override {
+    DominatorTree DomTree(F);
+    DomTree.FindImmediateDominators();
+    LoopNestingForest Forest(F, DomTree);
+
+    bool Changed = false;
+    for (OurLoop *L : Forest.GetLoopsInnermostFirst()) {
+      if (!L->IsReducible() || !L->GetPreheader()) {
+        errs() << "--- Skipping loop with header ";
+        L->GetHeader()->printAsOperand(errs(), false);
+        errs() << ": it is irreducible or has no preheader ---\n";
+        continue;
+      }
+
+      Changed |= RunOnLoop(L);
+    }
+
+    return Changed;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
 };
 
 }
@@ -1,22 +1,14 @@
 #include "llvm/IR/Instruction.h"
-#include "llvm/Transforms/Utils.h"
-#include "llvm/Transforms/Utils/LoopPeel.h"
-#include "llvm/Transforms/Utils/LoopSimplify.h"
-#include "llvm/Transforms/Utils/LoopUtils.h"
-#include "llvm/Transforms/Utils/SizeOpts.h"
-#include "llvm/Transforms/Utils/UnrollLoop.h"
-#include "llvm/Analysis/LoopAnalysisManager.h"
-#include "llvm/Analysis/LoopInfo.h"
-#include "llvm/Analysis/LoopUnrollAnalyzer.h"
-#include "llvm/Transforms/Utils/BasicBlockUtils.h"
-#include "llvm/Transforms/Utils/LoopUtils.h"
-#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
-#include "llvm/Analysis/LoopPass.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/IR/IRBuilder.h"
+#include "../DominatorTreePass/DominatorTree.h"
+#include "../DominatorTreePass/LoopNestingForest.h"
 
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 
@@ -24,9 +16,9 @@ using namespace llvm;
 
 namespace {
 
-struct LoopUnrollingPass : public LoopPass {
+struct LoopUnrollingPass : public FunctionPass {
   static char ID;
-  LoopUnrollingPass() : LoopPass(ID) {};
+  LoopUnrollingPass() : FunctionPass(ID) {};
 
   std::vector<BasicBlock *> LoopBasicBlocks = {};
   std::unordered_map<Value *, Value *> VariablesMap = {};
@@ -34,8 +26,8 @@ struct LoopUnrollingPass : public LoopPass {
   int LoopBound = -1;
   bool IsLoopBoundConstant;
 
-  void MapVariables(Loop *L) {
-    Function *F = L->getHeader()->getParent();
+  void MapVariables(OurLoop *L) {
+    Function *F = L->GetHeader()->getParent();
 
     for (BasicBlock &BB : *F) {
       for (Instruction &Instr : BB) {
@@ -148,25 +140,25 @@ struct LoopUnrollingPass : public LoopPass {
 
   // U potpunosti uklanjamo petlju i dobijamo ekvivalentan program tako sto naredbe iz njenog tela ponavljamo onoliko puta
   // kolika je bila granica za iteraciju
-  void FullyUnrollLoop(Loop *L)
+  void FullyUnrollLoop(OurLoop *L)
   {
     std::vector<BasicBlock *> LoopBasicBlocksCopy(LoopBasicBlocks.size() - 2);
     // Ne uzimamo prvi i poslednji BB koji ulazi u sastav petlje iz originalnog IR-a, od znacaja nam je samo onaj koji
     // sadrzi logiku koju razmotavamo i koju cemo ponoviti vise puta
     std::copy(LoopBasicBlocks.begin() + 1, LoopBasicBlocks.end() - 1, LoopBasicBlocksCopy.begin());
 
-    L->getLoopPreheader()->getTerminator()->setSuccessor(0, LoopBasicBlocks[1]);
+    L->GetPreheader()->getTerminator()->setSuccessor(0, LoopBasicBlocks[1]);
     // za pretposlednji BB postavljamo kao successora izlazni BB
-    LoopBasicBlocks[LoopBasicBlocks.size() - 2]->getTerminator()->setSuccessor(0, L->getExitBlock());
+    LoopBasicBlocks[LoopBasicBlocks.size() - 2]->getTerminator()->setSuccessor(0, L->GetExitBlock());
 
     // Prvi i poslednji BB uklanjamo u potpunosti
     LoopBasicBlocks.front()->eraseFromParent();
     LoopBasicBlocks.back()->eraseFromParent();
 
-    DuplicateLoop(LoopBasicBlocksCopy, LoopBound - 1, L->getExitBlock());
+    DuplicateLoop(LoopBasicBlocksCopy, LoopBound - 1, L->GetExitBlock());
   }
 
-  void CopyLoop(Loop *L)
+  void CopyLoop(OurLoop *L)
   {
     std::vector<BasicBlock *> LoopBasicBlocksCopy = {};
     std::unordered_map<Value *, Value *> Mapping = {};
@@ -175,7 +167,7 @@ struct LoopUnrollingPass : public LoopPass {
 
     BasicBlock *NewBasicBlock = nullptr;
     Instruction *InstrCopy = nullptr;
-    BasicBlock *ExitBlock = L->getExitBlock();
+    BasicBlock *ExitBlock = L->GetExitBlock();
     IRBuilder<> Builder(ExitBlock);
 
     for (size_t i = 0; i < LoopBasicBlocks.size(); ++i) {
@@ -215,7 +207,7 @@ struct LoopUnrollingPass : public LoopPass {
     LoopBasicBlocks.front()->getTerminator()->setSuccessor(1, LoopBasicBlocksCopy.front());
   }
 
-  void PartiallyUnrollLoop(Loop *L)
+  void PartiallyUnrollLoop(OurLoop *L)
   {
     int UnrollingFactor = 4;
 
@@ -242,7 +234,7 @@ struct LoopUnrollingPass : public LoopPass {
     }
   }
 
-  void UnrollLoop(Loop *L)
+  void UnrollLoop(OurLoop *L)
   {
     if (IsLoopBoundConstant) {
       FullyUnrollLoop(L);
@@ -251,14 +243,41 @@ struct LoopUnrollingPass : public LoopPass {
     }
   }
 
-  bool runOnLoop(Loop *L, LPPassManager &) override {
-    LoopBasicBlocks = L->getBlocksVector();
+  bool RunOnLoop(OurLoop *L) {
+    LoopBasicBlocks = L->GetBlocks();
     MapVariables(L);
     FindLoopBoundAndCounter();
     UnrollLoop(L);
 
     return true;
   }
+
+  // Petlje se nalaze nasim stablom dominatora i sumom petlji, jednom pre izmena, i obradjuju se od
+  // unutrasnjih ka spoljasnjim, kao u LoopPass-u. Nesvodljive petlje se sada vide, ali se preskacu.
+  bool runOnFunction(Function &F) override {
+    DominatorTree DomTree(F);
+    DomTree.FindImmediateDominators();
+    LoopNestingForest Forest(F, DomTree);
+
+    bool Changed = false;
+    for (OurLoop *L : Forest.GetLoopsInnermostFirst()) {
+      if (!L->IsReducible() || !L->GetPreheader() || !L->GetExitBlock()) {
+        errs() << "--- Skipping loop with header ";
+        L->GetHeader()->printAsOperand(errs(), false);
+        errs() << ": it is irreducible or has no preheader or single exit block ---\n";
+        continue;
+      }
+
+      Changed |= RunOnLoop(L);
+    }
+
+    return Changed;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
 };
 
 }
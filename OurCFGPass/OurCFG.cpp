@@ -3,85 +3,149 @@
 //
 
 #include "OurCFG.h"
+#include "../Graph/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
 
-void OurCFG::AddEdge(BasicBlock *From, BasicBlock *To)
-{
-  AdjacencyList[From].push_back(To);
-}
+#include <mutex>
 
 void OurCFG::CreateCFG(Function &F)
 {
   FunctionName = F.getName().str();
+  Func = &F;
+  Graph = DenseCFG::Get(F);
+}
 
-  for (BasicBlock &BB : F) {
-    for (auto* Successor : successors(&BB))
-      AddEdge(&BB, Successor);
-  }
+void OurCFG::SetExportOptions(const GraphExportOptions &NewOptions)
+{
+  Options = NewOptions;
+}
+
+std::string OurCFG::GetFileName() const
+{
+  return FunctionName + GetGraphFileExtension(Options.Format);
+}
+
+// Cvorovi su indeksi blokova u DenseCFG-u; ModuleSlotTracker numerise funkciju samo jednom
+void OurCFG::Export(GraphExporter &Exporter)
+{
+  ModuleSlotTracker Slots(Func->getParent());
+  Slots.incorporateFunction(*Func);
+
+  std::string Name;
+  std::string Body;
+  for (unsigned Index = 0; Index < Graph->GetNumOfBlocks(); ++Index)
+    ExportBasicBlock(Index, Exporter, Slots, Name, Body);
 }
 
 void OurCFG::DumpToFile()
 {
-  std::error_code error;
-  raw_fd_stream File(FunctionName + ".dot", error);
+  GraphExporter Exporter(Options, "CFG for '" + FunctionName + "' function", {"#73167d", "#811b8c"});
+  std::string Error;
+
+  if (!Exporter.Open(GetFileName(), Error)) {
+    errs() << Error << "\n";
+    return;
+  }
 
-  File << "digraph \"CFG for '" << FunctionName << "' function\" {\n"
-          "\tlabel=\"CFG for '" << FunctionName << "' function\";\n";
+  Export(Exporter);
+  if (!Exporter.Close(Error))
+    errs() << Error << "\n";
+}
 
-  for (auto &kvp : AdjacencyList)
-    DumpBasicBlock(kvp.first, File);
+std::string OurCFG::ExportToString()
+{
+  GraphExporter Exporter(Options, "CFG for '" + FunctionName + "' function", {"#73167d", "#811b8c"});
+  std::string Error;
 
-  File << "}\n";
-  File.close();
+  Export(Exporter);
+  Exporter.Close(Error);
+  return Exporter.GetText();
 }
 
-void OurCFG::DumpBasicBlock(BasicBlock *BB, raw_fd_stream &File, bool only)
+// Isto kao DumpToFile za svaku funkciju, ali svaka funkcija u svom poslu na ThreadPool-u
+void OurCFG::DumpModule(Module &M, const GraphExportOptions &Options, unsigned NumOfThreads)
 {
-  bool MultipleSuccessors = false;
+  std::vector<std::unique_ptr<OurCFG>> CFGs;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    CFGs.push_back(std::make_unique<OurCFG>());
+    CFGs.back()->CreateCFG(F);
+    CFGs.back()->SetExportOptions(Options);
+  }
 
-  File << "\tNode" << BB << " [shape=record, color=\"#73167d\", style=filled, fillcolor=\"#811b8c\", label=\"{";
+  std::mutex ErrorsLock;
+  std::vector<std::string> Errors;
+  {
+    ThreadPool Workers(NumOfThreads);
 
-  BB->printAsOperand(File, false);
-  if (only) {
-    File << "\\l ";
+    for (auto &CFG : CFGs) {
+      OurCFG* Current = CFG.get();
 
-    for (Instruction &Instr : *BB) {
-      if (auto* BranchInstruction = dyn_cast<BranchInst>(&Instr)) {
-        if (BranchInstruction->isConditional()) {
-          MultipleSuccessors = true;
-          File << "|{<s0>T|<s1>F}";
-        } else {
-          File << Instr << "\\l ";
-        }
-      }
-
-      if (auto* SwitchInstruction = dyn_cast<SwitchInst>(&Instr)) {
-        MultipleSuccessors = true;
-
-        File << "|{<s0>def";
-
-        for (auto Case : SwitchInstruction->cases()) {
-          unsigned CaseIndex = Case.getCaseIndex();
-          File << "|<s" << (CaseIndex + 1) << ">";
-
-          auto* CaseOperand = SwitchInstruction->getOperand(2 * CaseIndex + 2);
-          CaseOperand->printAsOperand(File, false);
-        }
-        File << "}";
-      } else {
-        File << Instr << "\\l ";
-      }
+      Workers.Async([Current, &ErrorsLock, &Errors] {
+        std::string Error;
+        if (GraphExporter::WriteFile(Current->GetFileName(), Current->ExportToString(), Error))
+          return;
+
+        std::lock_guard<std::mutex> Guard(ErrorsLock);
+        Errors.push_back(Error);
+      });
+    }
+
+    Workers.Wait();
+  }
+
+  for (const std::string &Error : Errors)
+    errs() << Error << "\n";
+}
+
+void OurCFG::ExportBasicBlock(unsigned Index, GraphExporter &Exporter, ModuleSlotTracker &Slots,
+                              std::string &Name, std::string &Body)
+{
+  BasicBlock* BB = Graph->GetBlock(Index);
+  Instruction* Terminator = BB->getTerminator();
+  std::vector<std::string> Ports;
+
+  BranchInst* BranchInstruction = dyn_cast_or_null<BranchInst>(Terminator);
+  SwitchInst* SwitchInstruction = dyn_cast_or_null<SwitchInst>(Terminator);
+
+  if (BranchInstruction && BranchInstruction->isConditional()) {
+    Ports = {"T", "F"};
+  } else if (SwitchInstruction) {
+    Ports.push_back("def");
+    for (auto Case : SwitchInstruction->cases()) {
+      SmallString<16> Value;
+      Case.getCaseValue()->getValue().toStringSigned(Value);
+      Ports.push_back(Value.str().str());
     }
   }
 
-  File << "}\"];\n";
-  unsigned Index = 0;
+  Name.clear();
+  raw_string_ostream NameStream(Name);
+  BB->printAsOperand(NameStream, false, Slots);
+  NameStream.flush();
+
+  Body.clear();
+  if (Exporter.GetBodies()) {
+    raw_string_ostream BodyStream(Body);
+
+    for (Instruction &Instr : *BB) {
+      if (&Instr == Terminator && !Ports.empty())
+        break;
 
-  for (auto Successor : AdjacencyList[BB]) {
-    if (MultipleSuccessors) {
-      File << "\tNode" << BB << ":s" << Index << " -> Node" << Successor << ";\n";
-      Index++;
-    } else {
-      File << "\tNode" << BB << " -> Node" << Successor << ";\n";
+      Instr.print(BodyStream, Slots);
+      BodyStream << "\n";
     }
+
+    BodyStream.flush();
+  }
+
+  Exporter.AddNode(Index, Name, Body, Ports);
+
+  int SuccessorIndex = 0;
+  for (unsigned Successor : Graph->GetSuccessors(Index)) {
+    Exporter.AddEdge(Index, Successor, Ports.empty() ? -1 : SuccessorIndex);
+    SuccessorIndex++;
   }
 }
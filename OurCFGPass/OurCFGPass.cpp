@@ -5,11 +5,23 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "OurCFG.h"
 
 using namespace llvm;
 
+static cl::opt<GraphFormat> Format("cfg-format", cl::init(GraphFormat::Dot),
+                                    cl::desc("Format of the CFG files"),
+                                    cl::values(clEnumValN(GraphFormat::Dot, "dot", "Graphviz .dot"),
+                                               clEnumValN(GraphFormat::Json, "json", "JSON with nodes and edges"),
+                                               clEnumValN(GraphFormat::EdgeList, "edges",
+                                                          "Edge list, readable by the Dominators tool")));
+static cl::opt<bool> NoBodies("cfg-no-bodies", cl::init(false),
+                              cl::desc("Write only block names and edges, without instructions"));
+static cl::opt<unsigned> NumOfThreads("cfg-threads", cl::init(0),
+                                      cl::desc("Worker threads for the module-wide CFG pass (0 means one per core)"));
+
 namespace {
 
 struct OurCFGPass : public FunctionPass {
@@ -19,14 +31,38 @@ struct OurCFGPass : public FunctionPass {
   bool runOnFunction(Function &F) override {
     OurCFG* CFG = new OurCFG();
     CFG->CreateCFG(F);
+    CFG->SetExportOptions({Format, !NoBodies});
     CFG->DumpToFile();
 
     delete CFG;
     return false;
   }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
+};
+
+struct OurModuleCFGPass : public ModulePass {
+  static char ID;
+  OurModuleCFGPass() : ModulePass(ID) {};
+
+  bool runOnModule(Module &M) override {
+    OurCFG::DumpModule(M, {Format, !NoBodies}, NumOfThreads);
+    return false;
+  }
+
+  bool doFinalization(Module &M) override {
+    DenseCFG::Clear();
+    return false;
+  }
 };
 
 }
 
 char OurCFGPass::ID = 0;
-static RegisterPass<OurCFGPass> X("cfg-pass", "Simple CFG pass");
\ No newline at end of file
+static RegisterPass<OurCFGPass> X("cfg-pass", "Simple CFG pass");
+
+char OurModuleCFGPass::ID = 0;
+static RegisterPass<OurModuleCFGPass> Y("cfg-module-pass", "CFG pass for all functions, in parallel");
\ No newline at end of file